@@ -0,0 +1,23 @@
+//  Copyright (c) 2024- David Lucius Severus
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  See accompanying file LICENSE.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt
+#include "../include/snowball.hpp"
+
+unsigned int
+factorial(unsigned int number)
+{
+  return number <= 1 ? number : factorial(number - 1) * number;
+}
+
+int
+main(void)
+{
+  // first run writes the baseline, later runs exit with 6 on a significant slowdown
+  sb::bench_baseline("snowball_bench.bin");
+  volatile unsigned int n = 12;
+  sb::bench("factorial(12)", [&]() { return factorial(n); });
+  sb::bench("factorial(20)", [&]() { return factorial(n + 8); }, 128);
+  return 0;
+}
@@ -0,0 +1,27 @@
+//  Copyright (c) 2024- David Lucius Severus
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  See accompanying file LICENSE.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt
+#include "../include/snowball.hpp"
+
+unsigned int
+factorial(unsigned int number)
+{
+  return number <= 1 ? number : factorial(number - 1) * number;
+}
+
+// run as: snowball_example_shard --shard=0/2 --timings=timings.txt
+//         snowball_example_shard --shard=1/2 --timings=timings.txt
+int
+main(int argc, char **argv)
+{
+  sb::init(argc, argv);
+  sb::test_case("Factorial of one", []() { sb::require(&factorial, 1, 1); });
+  sb::test_case("Factorial of three", []() { sb::require(&factorial, 6, 3); });
+  sb::test_case("Factorial of ten", []() { sb::require(&factorial, 3628800, 10); });
+  sb::test_case("Factorial sweep", []() {
+    for ( unsigned int i = 2; i < 13; ++i ) sb::require(factorial(i) == factorial(i - 1) * i);
+  });
+  return 0;
+}
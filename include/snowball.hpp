@@ -20,37 +20,243 @@
 #include "../../src/except.hpp"
 #include "../../src/exit.hpp"
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+#include <coroutine>
+#include <cxxabi.h>
+#include <exception>
+#include <new>
+
+#include <dirent.h>
+#include <dlfcn.h>
+#include <elf.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/epoll.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
 namespace snowball
 {
 using string_type = micron::string;
 
 inline string_type __global_test_case{};
+// copy of the current test case name read by failure reports on any thread, swapped atomically
+inline const char *__global_case_name = nullptr;
 inline void (*__global_on_require)() = nullptr;
 inline void (*__global_on_check)() = nullptr;
+inline const char *__global_bench_baseline = nullptr;
+inline bool __global_bench_update = false;
+inline u32 __global_shard_index = 0;
+inline u32 __global_shard_count = 1;
+inline const char *__global_timings = nullptr;
+inline const char *__global_cache = nullptr;
+inline bool __global_cache_force = false;
+inline u64 __global_fuzz_seed = 0;
+inline const char *__global_crash_dir = nullptr;
+inline u64 __global_failures = 0;
 
 namespace config
 {
 constexpr static const bool __default_print_stack = true;
 constexpr static const bool __default_abort_on_require = true;
 constexpr static const bool __default_else_throw_on_require = false;
+constexpr static const size_t __default_bench_samples = 64;
+constexpr static const u64 __default_bench_sample_cycles = 1ULL << 20;
+// one-sided 1% critical value of the Mann-Whitney normal approximation
+constexpr static const double __default_bench_z = 2.326;
+// slowdowns smaller than this are never reported, however significant
+constexpr static const double __default_bench_tolerance = 0.05;
+// failing rows/elements listed in a single report
+constexpr static const size_t __default_table_report = 16;
+constexpr static const u64 __default_max_ulps = 4;
+// upper bound on re-runs spent minimizing a failing input
+constexpr static const size_t __default_shrink_budget = 4096;
+// fuzz_bytes() inputs per run, largest input, and the corpus it keeps in memory
+constexpr static const size_t __default_fuzz_runs = 1 << 20;
+constexpr static const size_t __default_fuzz_max_len = 4096;
+constexpr static const size_t __default_corpus_bytes = 1 << 26;
+constexpr static const u32 __default_corpus_entries = 1 << 16;
+// fuzz_run(): slice length, per-slice discount of past yield, weight of the exploration term, and
+// the corpus each byte buffer target keeps
+constexpr static const u64 __default_sched_slice_ms = 20;
+constexpr static const double __default_sched_discount = 0.95;
+constexpr static const double __default_sched_explore = 0.5;
+constexpr static const size_t __default_target_corpus_bytes = 1 << 22;
+constexpr static const u32 __default_target_corpus_entries = 1 << 12;
+// generated strings: longest random text, grammar recursion depth and grammar length budget
+constexpr static const size_t __default_string_max_len = 256;
+constexpr static const u32 __default_grammar_depth = 24;
+constexpr static const size_t __default_grammar_len = 4096;
+// failures sharing a kind and this many innermost frames are one bug, and at most this many distinct
+// ones are kept per run
+constexpr static const u32 __default_bucket_frames = 4;
+constexpr static const u32 __default_buckets = 64;
+// fuzz_stateful() sequences and steps per sequence
+constexpr static const size_t __default_stateful_runs = 256;
+constexpr static const u32 __default_stateful_steps = 100;
+// async test cases still running after this long fail
+constexpr static const u64 __default_async_timeout_ms = 10000;
 };     // namespace config
 
 // start out functions
 
+// failure reports are staged in a per thread buffer from the first __print_error() until the failure
+// callback, then written out with a single write(2), so reports from several threads never interleave
+// and failing assertions in worker threads don't contend on anything but the failure counter
+namespace __impl
+{
+struct __stage {
+  char buf[4096];
+  u32 len;
+  bool active;
+};
+
+inline thread_local __stage __tls_stage{};
+// set while an async test case runs on this thread, reports name it over the global test case
+inline thread_local const char *__tls_case_name = nullptr;
+
+inline void
+__stage_flush(__stage &st)
+{
+  const char *p = st.buf;
+  size_t n = st.len;
+  while ( n ) {
+    const ssize_t w = ::write(STDOUT_FILENO, p, n);
+    if ( w < 0 && errno == EINTR ) continue;
+    if ( w <= 0 ) break;
+    p += w;
+    n -= static_cast<size_t>(w);
+  }
+  st.len = 0;
+}
+
+inline void
+__stage_write(__stage &st, const char *p, size_t n)
+{
+  while ( n ) {
+    if ( st.len == sizeof(st.buf) ) __stage_flush(st);
+    size_t k = sizeof(st.buf) - st.len;
+    if ( k > n ) k = n;
+    __builtin_memcpy(st.buf + st.len, p, k);
+    st.len += static_cast<u32>(k);
+    p += k;
+    n -= k;
+  }
+}
+
+template <typename T>
+void
+__stage_put(__stage &st, const T &v)
+{
+  using U = micron::remove_cvref_t<T>;
+  if constexpr ( micron::is_same_v<U, bool> ) {
+    if ( v )
+      __stage_write(st, "true", 4);
+    else
+      __stage_write(st, "false", 5);
+  } else if constexpr ( micron::is_same_v<U, char> ) {
+    __stage_write(st, &v, 1);
+  } else if constexpr ( micron::is_integral_v<U> ) {
+    char tmp[24];
+    int n = 0;
+    const bool neg = v < 0;
+    u64 x = neg ? 0 - static_cast<u64>(v) : static_cast<u64>(v);
+    do {
+      tmp[sizeof(tmp) - ++n] = static_cast<char>('0' + x % 10);
+      x /= 10;
+    } while ( x );
+    if ( neg ) tmp[sizeof(tmp) - ++n] = '-';
+    __stage_write(st, tmp + sizeof(tmp) - n, static_cast<size_t>(n));
+  } else if constexpr ( micron::is_pointer_v<U> || micron::is_array_v<U> ) {
+    if constexpr ( micron::is_same_v<micron::remove_cv_t<micron::remove_pointer_t<micron::decay_t<U>>>, char> ) {
+      const char *str = v;
+      __stage_write(st, str, __builtin_strlen(str));
+    } else {
+      char tmp[18] = { '0', 'x' };
+      u64 x = reinterpret_cast<umax_t>(v);
+      int n = 0;
+      for ( u64 y = x; y; y >>= 4 ) ++n;
+      if ( n == 0 ) n = 1;
+      for ( int i = n; i > 0; --i, x >>= 4 ) tmp[1 + i] = "0123456789abcdef"[x & 15];
+      __stage_write(st, tmp, static_cast<size_t>(n + 2));
+    }
+  } else if constexpr ( requires { v.data(); v.size(); } ) {
+    __stage_write(st, v.data(), v.size());
+  } else {
+    // not formattable here, keep the order at least
+    __stage_flush(st);
+    micron::io::print(v);
+  }
+}
+
+inline void
+__report_begin(void)
+{
+  __stage &st = __tls_stage;
+  if ( st.active ) return;
+  st.active = true;
+  const char *name = __tls_case_name ? __tls_case_name : __atomic_load_n(&__global_case_name, __ATOMIC_ACQUIRE);
+  if ( name ) {
+    static const char header[] = "\033[34m:: Test case error...\033[0m\n\r\033[90m[ ";
+    __stage_write(st, header, sizeof(header) - 1);
+    __stage_write(st, name, __builtin_strlen(name));
+    __stage_write(st, " ]\033[0m\n\r", sizeof(" ]\033[0m\n\r") - 1);
+  }
+}
+
+inline void
+__report_end(void)
+{
+  __stage &st = __tls_stage;
+  if ( !st.active ) return;
+  __stage_flush(st);
+  st.active = false;
+}
+};     // namespace __impl
+
+namespace __impl
+{
+inline void __timings_on_exit(void);
+};     // namespace __impl
+
+// failures leave through sys_exit, past atexit, so whatever must outlive the run is written here
 [[noreturn]] inline void
 __exit(void)
 {
+  __impl::__report_end();
+  __impl::__timings_on_exit();
   micron::sys_exit(6);
 }
 
 [[noreturn]] inline void
 __abort(void)
 {
+  __impl::__report_end();
   if constexpr ( config::__default_abort_on_require ) {
     __exit();
   } else if constexpr ( config::__default_else_throw_on_require ) {
     throw micron::runtime{ "snowball exception in abort()" };
   }
+  __impl::__timings_on_exit();
   micron::sys_exit(6);
 }
 
@@ -58,42 +264,29 @@ template <typename... T>
 inline __attribute__((always_inline)) void
 __print(const T &...args)
 {
-  micron::io::print(args...);
+  if ( __impl::__tls_stage.active ) [[unlikely]]
+    (__impl::__stage_put(__impl::__tls_stage, args), ...);
+  else
+    micron::io::print(args...);
 }
 
 template <typename... T>
 inline __attribute__((always_inline)) void
 __print_error(const T &...args)
 {
-  if ( __global_test_case.size() ) {
-    micron::io::print("\033[34m:: Test case error...\033[0m\n\r");
-    micron::io::print("\033[90m");
-    micron::io::print("[ ", __global_test_case, " ]");
-    micron::io::print("\033[0m");
-    micron::io::print("\n\r");
-  }
-  micron::io::print(args...);
+  __impl::__report_begin();
+  (__impl::__stage_put(__impl::__tls_stage, args), ...);
 }
 
 // end out functions
 
-inline void
-__print_stack()
+#if !defined(__micron_arch_arm32)
+// return addresses along the frame pointer chain starting at fp; only reads memory, so it is also
+// used from the crash handler
+inline int
+__walk_frames(void **fp, void **buffer, int max_frames)
 {
-#if defined(__micron_arch_arm32)
-  // arm32 thumb pins r7 as FP, but -Ofast omits the FP and frees r7 for
-  // general allocation. Lowering __builtin_frame_address(0) under LTO then
-  // emits an r7 reference into contexts where r7 is busy, producing
-  // "r7 cannot be used in 'asm' here". Stack tracing requires a real FP, so
-  // skip the walk on arm32.
-  __print("Start of call stack:\n\r");
-  __print("(unavailable on arm32; build without -fomit-frame-pointer for traces)\n\r");
-#else
-  constexpr int max_frames = 64;
-  void *buffer[max_frames];
   int n = 0;
-
-  void **fp = static_cast<void **>(__builtin_frame_address(0));
   for ( int i = 0; i < max_frames && fp; ++i ) {
     void *next_fp = fp[0];
     void *next_ret = fp[1];
@@ -102,7 +295,12 @@ __print_stack()
     buffer[n++] = next_ret;
     fp = static_cast<void **>(next_fp);
   }
+  return n;
+}
 
+inline void
+__print_frames(void *const *buffer, int n)
+{
   __print("Start of call stack:\n\r");
   if ( n == 0 ) {
     __print("(unavailable; compile with -fno-omit-frame-pointer for traces)\n\r");
@@ -115,6 +313,24 @@ __print_stack()
     __print(buffer[i]);
     __print("\n\r");
   }
+}
+#endif
+
+inline void
+__print_stack()
+{
+#if defined(__micron_arch_arm32)
+  // arm32 thumb pins r7 as FP, but -Ofast omits the FP and frees r7 for
+  // general allocation. Lowering __builtin_frame_address(0) under LTO then
+  // emits an r7 reference into contexts where r7 is busy, producing
+  // "r7 cannot be used in 'asm' here". Stack tracing requires a real FP, so
+  // skip the walk on arm32.
+  __print("Start of call stack:\n\r");
+  __print("(unavailable on arm32; build without -fomit-frame-pointer for traces)\n\r");
+#else
+  constexpr int max_frames = 64;
+  void *buffer[max_frames];
+  __print_frames(buffer, __walk_frames(static_cast<void **>(__builtin_frame_address(0)), buffer, max_frames));
 #endif
 }
 
@@ -236,24 +452,99 @@ check_callback(void (*fn)())
   if ( fn != nullptr ) __global_on_check = fn;
 }
 
+// sets the file benchmark samples are stored in and compared against
+// if update is set, existing records are overwritten by the current run
+inline void
+bench_baseline(const char *path, bool update = false)
+{
+  __global_bench_baseline = path;
+  __global_bench_update = update;
+}
+
+// only test cases assigned to shard index of count are run, see test_case(name, fn)
+inline void
+shard(u32 index, u32 count)
+{
+  if ( count == 0 || index >= count ) return;
+  __global_shard_index = index;
+  __global_shard_count = count;
+}
+
+// per test case durations are read from and written back to this file
+inline void
+timings_file(const char *path)
+{
+  __global_timings = path;
+}
+
+// test cases passed as callables that pass are recorded here, and skipped on the next run of the
+// same binary unless force is set; a test case that fuzzes only with a fixed fuzz_seed(), which is
+// then part of its key
+inline void
+result_cache(const char *path, bool force = false)
+{
+  __global_cache = path;
+  __global_cache_force = force;
+}
+
+// fixes the fuzzing seed; each test case run through test_case(name, fn) is reseeded from it
+inline void
+fuzz_seed(u64 seed)
+{
+  __global_fuzz_seed = seed;
+}
+
+// crashing fuzz inputs are written to this directory (default: the working directory)
+inline void
+crash_dir(const char *path)
+{
+  __global_crash_dir = path;
+}
+
 inline void
 __require_clbck(void)
 {
+  __impl::__report_end();
+  __atomic_fetch_add(&__global_failures, 1, __ATOMIC_RELAXED);
   if ( __global_on_require != nullptr ) __global_on_require();
 }
 
 inline void
 __check_clbck(void)
 {
+  __impl::__report_end();
+  __atomic_fetch_add(&__global_failures, 1, __ATOMIC_RELAXED);
   if ( __global_on_check != nullptr ) __global_on_check();
 }
 
+namespace __impl
+{
+// publishes a copy of the current name for reports from other threads. old copies are never freed,
+// a worker may still be reading one; repeated names reuse the current copy
+inline void
+__publish_case_name(void)
+{
+  const char *cur = __atomic_load_n(&__global_case_name, __ATOMIC_ACQUIRE);
+  const size_t n = __global_test_case.size();
+  if ( n == 0 ) {
+    __atomic_store_n(&__global_case_name, static_cast<const char *>(nullptr), __ATOMIC_RELEASE);
+    return;
+  }
+  if ( cur && __builtin_strlen(cur) == n && __builtin_memcmp(cur, __global_test_case.data(), n) == 0 ) return;
+  char *copy = new char[n + 1];
+  __builtin_memcpy(copy, __global_test_case.data(), n);
+  copy[n] = 0;
+  __atomic_store_n(&__global_case_name, static_cast<const char *>(copy), __ATOMIC_RELEASE);
+}
+};     // namespace __impl
+
 template <typename T>
   requires(micron::is_object_v<T>)
 string_type
 test_case(const T &str)
 {
   __global_test_case = str;
+  __impl::__publish_case_name();
   return __global_test_case;
 }
 
@@ -261,6 +552,7 @@ inline string_type
 test_case(const char *str)
 {
   __global_test_case = str;
+  __impl::__publish_case_name();
   return __global_test_case;
 }
 
@@ -268,6 +560,7 @@ inline void
 end_test_case(void)
 {
   __global_test_case.clear();
+  __impl::__publish_case_name();
 }
 
 [[noreturn]] inline void
@@ -914,57 +1207,5967 @@ check_nothrow(Fn &&fn, Args &&...args)
   }
 };
 
+// table driven requires/checks
+// each row is a micron::tuple<Expected, Inputs...>; every row is evaluated before anything is reported,
+// mismatching rows are collected into a bitset and reported once
+
+template <typename... T> using row = micron::tuple<T...>;
+
 namespace __impl
 {
-inline u64
-__xorshift64(u64 &s)
+template <typename T> void __print_element(const T &v);
+
+template <typename Fn, typename Row>
+[[gnu::always_inline]] inline auto
+__table_call(Fn &fn, const Row &row)
 {
-  s ^= s << 13;
-  s ^= s >> 7;
-  s ^= s << 17;
-  return s;
+  return micron::apply([&](const auto &, auto... inputs) { return fn(micron::forward<decltype(inputs)>(inputs)...); },
+                       row);
 }
 
-[[gnu::always_inline]] inline u64
-__cycle_counter() noexcept
+// what fn gave for the first mismatching rows is kept for the report, when its type allows it
+template <typename Got>
+concept __table_keepable = requires(Got a, const Got &b) {
+  Got{};
+  a = b;
+};
+struct __table_unkept {
+};
+
+template <typename Fn, typename Row, typename Got>
+size_t
+__table_eval(Fn &fn, const Row *rows, size_t n, u64 *bits, Got *got)
 {
-#if defined(__micron_arch_amd64)
-  u32 lo = 0, hi = 0;
-  asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
-  return (u64(hi) << 32) | u64(lo);
-#elif defined(__micron_arch_arm64)
-  u64 v;
-  asm volatile("mrs %0, cntvct_el0" : "=r"(v));
-  return v;
-#elif defined(__micron_arch_arm32)
-  u32 lo, hi;
-  asm volatile("mrrc p15, 1, %0, %1, c14" : "=r"(lo), "=r"(hi));
-  return (u64(hi) << 32) | u64(lo);
+  size_t bad = 0;
+  for ( size_t i = 0; i < n; ++i ) {
+    const auto r = __table_call(fn, rows[i]);
+    const u64 miss = !micron::apply([&](const auto &expected, const auto &...) { return r == expected; }, rows[i]);
+    if constexpr ( !micron::is_same_v<Got, __table_unkept> )
+      if ( miss && bad < config::__default_table_report ) got[bad] = r;
+    bits[i >> 6] |= miss << (i & 63);
+    bad += miss;
+  }
+  return bad;
+}
+
+template <typename Row, typename Got>
+void
+__table_report(const char *who, const Row *rows, const Got *got, const u64 *bits, size_t n, size_t bad)
+{
+  __print_error("\033[34msnowball ", who, " failure:\033[0m ", bad, " of ", n, " rows mismatched, rows:");
+  size_t shown = 0;
+  for ( size_t w = 0; w < (n + 63) / 64 && shown < config::__default_table_report; ++w ) {
+    for ( u64 word = bits[w]; word && shown < config::__default_table_report; word &= word - 1, ++shown ) {
+      __print(" ", w * 64 + static_cast<size_t>(__builtin_ctzll(word)));
+    }
+  }
+  if ( bad > shown ) __print(" ...");
+  __print("\n\r");
+  shown = 0;
+  for ( size_t w = 0; w < (n + 63) / 64 && shown < config::__default_table_report; ++w ) {
+    for ( u64 word = bits[w]; word && shown < config::__default_table_report; word &= word - 1, ++shown ) {
+      const size_t i = w * 64 + static_cast<size_t>(__builtin_ctzll(word));
+      __print("  row ", i, ": ");
+      if constexpr ( !micron::is_same_v<Got, __table_unkept> ) {
+        __print("got ");
+        __print_element(got[shown]);
+        __print(", ");
+      }
+      __print("expected ");
+      micron::apply([](const auto &expected, const auto &...) { __print_element(expected); }, rows[i]);
+      __print("\n\r");
+    }
+  }
+}
+
+// returns the number of mismatching rows, reports them if there were any
+template <typename Fn, typename Row>
+size_t
+__table(const char *who, Fn &fn, const Row *rows, size_t n)
+{
+  using got_t = micron::remove_cvref_t<decltype(__table_call(fn, *rows))>;
+  using kept_t = micron::conditional_t<__table_keepable<got_t>, got_t, __table_unkept>;
+  u64 *bits = new u64[(n + 63) / 64 + 1]{};
+  kept_t *got = new kept_t[config::__default_table_report]{};
+  size_t bad = __table_eval(fn, rows, n, bits, got);
+  if ( bad ) __table_report(who, rows, got, bits, n, bad);
+  delete[] got;
+  delete[] bits;
+  return bad;
+}
+
+// contiguous ranges: arrays or anything with data()/size()
+template <typename R>
+constexpr auto
+__range_data(const R &r)
+{
+  if constexpr ( micron::is_array_v<R> )
+    return &r[0];
+  else
+    return r.data();
+}
+
+template <typename R>
+constexpr size_t
+__range_size(const R &r)
+{
+  if constexpr ( micron::is_array_v<R> )
+    return sizeof(r) / sizeof(r[0]);
+  else
+    return r.size();
+}
+};     // namespace __impl
+
+template <typename Fn, typename Row>
+void
+require_table(Fn &&fn, const Row *rows, size_t n)
+{
+  if ( __impl::__table("require_table()", fn, rows, n) ) {
+    should_print_stack();
+    __require_clbck();
+    __abort();
+  }
+}
+
+template <typename Fn, typename Rows>
+  requires(!micron::is_member_function_pointer_v<micron::remove_cvref_t<Fn>>)
+void
+require_table(Fn &&fn, const Rows &rows)
+{
+  require_table(fn, __impl::__range_data(rows), __impl::__range_size(rows));
+}
+
+template <typename Object, typename Fn, typename Rows>
+  requires(micron::is_member_function_pointer_v<micron::remove_cvref_t<Fn>>)
+void
+require_table(Object &object, Fn &&fn, const Rows &rows)
+{
+  auto call = [&](const auto &...inputs) { return (object.*fn)(inputs...); };
+  require_table(call, __impl::__range_data(rows), __impl::__range_size(rows));
+}
+
+template <typename Fn, typename Row>
+void
+check_table(Fn &&fn, const Row *rows, size_t n)
+{
+  if ( __impl::__table("check_table()", fn, rows, n) ) {
+    should_print_stack();
+    __check_clbck();
+  }
+}
+
+template <typename Fn, typename Rows>
+  requires(!micron::is_member_function_pointer_v<micron::remove_cvref_t<Fn>>)
+void
+check_table(Fn &&fn, const Rows &rows)
+{
+  check_table(fn, __impl::__range_data(rows), __impl::__range_size(rows));
+}
+
+template <typename Object, typename Fn, typename Rows>
+  requires(micron::is_member_function_pointer_v<micron::remove_cvref_t<Fn>>)
+void
+check_table(Object &object, Fn &&fn, const Rows &rows)
+{
+  auto call = [&](const auto &...inputs) { return (object.*fn)(inputs...); };
+  check_table(call, __impl::__range_data(rows), __impl::__range_size(rows));
+}
+
+// range equality
+// for contiguous ranges of types whose bytes fully determine equality, compared as raw memory with
+// avx2/neon block compares; the first mismatch is reported along with a hex window around it
+
+template <typename T>
+concept __bytewise_comparable = micron::is_trivially_copyable_v<T> && __has_unique_object_representations(T);
+
+namespace __impl
+{
+inline size_t
+__first_mismatch(const u8 *a, const u8 *b, size_t n) noexcept
+{
+  size_t i = 0;
+#if defined(__AVX2__)
+  for ( ; i + 128 <= n; i += 128 ) {
+    const __m256i *va = reinterpret_cast<const __m256i *>(a + i);
+    const __m256i *vb = reinterpret_cast<const __m256i *>(b + i);
+    __m256i x0 = _mm256_xor_si256(_mm256_loadu_si256(va), _mm256_loadu_si256(vb));
+    __m256i x1 = _mm256_xor_si256(_mm256_loadu_si256(va + 1), _mm256_loadu_si256(vb + 1));
+    __m256i x2 = _mm256_xor_si256(_mm256_loadu_si256(va + 2), _mm256_loadu_si256(vb + 2));
+    __m256i x3 = _mm256_xor_si256(_mm256_loadu_si256(va + 3), _mm256_loadu_si256(vb + 3));
+    __m256i any = _mm256_or_si256(_mm256_or_si256(x0, x1), _mm256_or_si256(x2, x3));
+    if ( !_mm256_testz_si256(any, any) ) break;
+  }
+  for ( ; i + 32 <= n; i += 32 ) {
+    __m256i eq = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)),
+                                   _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)));
+    u32 diff = ~static_cast<u32>(_mm256_movemask_epi8(eq));
+    if ( diff ) return i + static_cast<size_t>(__builtin_ctz(diff));
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  for ( ; i + 64 <= n; i += 64 ) {
+    uint8x16_t e0 = vceqq_u8(vld1q_u8(a + i), vld1q_u8(b + i));
+    uint8x16_t e1 = vceqq_u8(vld1q_u8(a + i + 16), vld1q_u8(b + i + 16));
+    uint8x16_t e2 = vceqq_u8(vld1q_u8(a + i + 32), vld1q_u8(b + i + 32));
+    uint8x16_t e3 = vceqq_u8(vld1q_u8(a + i + 48), vld1q_u8(b + i + 48));
+    if ( vminvq_u8(vandq_u8(vandq_u8(e0, e1), vandq_u8(e2, e3))) != 0xff ) break;
+  }
+#endif
+  for ( ; i + 8 <= n; i += 8 ) {
+    u64 x, y;
+    __builtin_memcpy(&x, a + i, 8);
+    __builtin_memcpy(&y, b + i, 8);
+    if ( x != y ) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+      return i + static_cast<size_t>(__builtin_ctzll(x ^ y)) / 8;
 #else
-  return 0;
+      return i + static_cast<size_t>(__builtin_clzll(x ^ y)) / 8;
 #endif
+    }
+  }
+  for ( ; i < n; ++i )
+    if ( a[i] != b[i] ) return i;
+  return n;
+}
+
+// prints bytes [from, to) as hex, bracketing the one at mark
+inline void
+__print_hex(const char *label, const u8 *p, size_t from, size_t to, size_t mark)
+{
+  constexpr const char *digits = "0123456789abcdef";
+  char line[256];
+  size_t k = 0;
+  for ( size_t i = from; i < to && k + 5 < sizeof(line); ++i ) {
+    line[k++] = i == mark ? '[' : ' ';
+    line[k++] = digits[p[i] >> 4];
+    line[k++] = digits[p[i] & 0xf];
+    if ( i == mark ) line[k++] = ']';
+  }
+  line[k] = 0;
+  __print("  ", label, " @", from, ":", static_cast<const char *>(line), "\n\r");
+}
+
+// returns whether both ranges are equal, reporting the first mismatch if not
+template <typename T>
+bool
+__equal_range(const char *who, const T *a, size_t na, const T *b, size_t nb)
+{
+  const size_t n = (na < nb ? na : nb) * sizeof(T);
+  const u8 *pa = reinterpret_cast<const u8 *>(a);
+  const u8 *pb = reinterpret_cast<const u8 *>(b);
+  const size_t off = __first_mismatch(pa, pb, n);
+  if ( off == n && na == nb ) return true;
+  if ( off == n ) {
+    __print_error("\033[34msnowball ", who, " failure:\033[0m ranges differ in length (", na, " vs ", nb, ").\n\r");
+    return false;
+  }
+  __print_error("\033[34msnowball ", who, " failure:\033[0m ranges differ at index ", off / sizeof(T), " (byte ", off,
+                ").\n\r");
+  size_t from = off > 16 ? off - 16 : 0;
+  if constexpr ( sizeof(T) <= 16 ) from -= from % sizeof(T);
+  const size_t to = off + 16 < n ? off + 16 : n;
+  __print_hex("a", pa, from, to, off);
+  __print_hex("b", pb, from, to, off);
+  return false;
 }
 };     // namespace __impl
 
-template <typename Fn>
+template <typename T>
+  requires(__bytewise_comparable<T>)
 void
-fuzz(Fn &&fn, size_t cnt)
+require_equal_range(const T *a, const T *b, size_t n)
 {
-  using traits = function_traits<decltype(&fn)>;
-  if constexpr ( traits::arity == 1 ) {
-    typename traits::template arg_type<0> var{};
+  if ( !__impl::__equal_range("require_equal_range()", a, n, b, n) ) {
+    should_print_stack();
+    __require_clbck();
+    __abort();
+  }
+}
+
+template <typename A, typename B>
+  requires(__bytewise_comparable<micron::remove_cvref_t<decltype(*__impl::__range_data(micron::declval<const A &>()))>>)
+void
+require_equal_range(const A &a, const B &b)
+{
+  if ( !__impl::__equal_range("require_equal_range()", __impl::__range_data(a), __impl::__range_size(a),
+                              __impl::__range_data(b), __impl::__range_size(b)) ) {
+    should_print_stack();
+    __require_clbck();
+    __abort();
+  }
+}
 
-    static u64 __seed = []() {
-      u64 s = __impl::__cycle_counter();
-      return s ? s : 0xdeadbeefULL;
-    }();
+template <typename T>
+  requires(__bytewise_comparable<T>)
+void
+check_equal_range(const T *a, const T *b, size_t n)
+{
+  if ( !__impl::__equal_range("check_equal_range()", a, n, b, n) ) {
+    should_print_stack();
+    __check_clbck();
+  }
+}
 
-    for ( size_t i = 0; i < cnt; ++i ) {
-      u64 r = __impl::__xorshift64(__seed) & ((1ULL << 25) - 1);
-      var = static_cast<typename traits::template arg_type<0>>(r);
-      fn(var);
+template <typename A, typename B>
+  requires(__bytewise_comparable<micron::remove_cvref_t<decltype(*__impl::__range_data(micron::declval<const A &>()))>>)
+void
+check_equal_range(const A &a, const B &b)
+{
+  if ( !__impl::__equal_range("check_equal_range()", __impl::__range_data(a), __impl::__range_size(a),
+                              __impl::__range_data(b), __impl::__range_size(b)) ) {
+    should_print_stack();
+    __check_clbck();
+  }
+}
+
+// multiset equality
+// two order-independent sums of element hashes are compared first; only when they differ is a flat
+// open-addressing count table built, to report which elements are extra and which are missing
+
+template <typename T>
+concept __hashable_element = __bytewise_comparable<T> || requires(const T &t) {
+  { t.data() };
+  { t.size() };
+  requires __bytewise_comparable<micron::remove_cvref_t<decltype(*t.data())>>;
+};
+
+namespace __impl
+{
+[[gnu::always_inline]] inline u64
+__mix64(u64 x) noexcept
+{
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+inline u64
+__hash_bytes(const void *ptr, size_t len) noexcept
+{
+  const u8 *p = static_cast<const u8 *>(ptr);
+  u64 h = __mix64(len + 0x9e3779b97f4a7c15ULL);
+  for ( ; len >= 8; p += 8, len -= 8 ) {
+    u64 w;
+    __builtin_memcpy(&w, p, 8);
+    h = __mix64(h ^ w);
+  }
+  if ( len ) {
+    u64 w = 0;
+    __builtin_memcpy(&w, p, len);
+    h = __mix64(h ^ w);
+  }
+  return h;
+}
+
+template <typename T>
+[[gnu::always_inline]] inline u64
+__hash_element(const T &v) noexcept
+{
+  if constexpr ( __bytewise_comparable<T> && sizeof(T) <= 8 ) {
+    u64 w = 0;
+    __builtin_memcpy(&w, &v, sizeof(T));
+    return __mix64(w + 0x9e3779b97f4a7c15ULL);
+  } else if constexpr ( __bytewise_comparable<T> ) {
+    return __hash_bytes(&v, sizeof(T));
+  } else {
+    return __hash_bytes(v.data(), v.size() * sizeof(*v.data()));
+  }
+}
+
+// equality as the hash sees it: bytes for bytewise elements, which need not have an operator==
+template <typename T>
+[[gnu::always_inline]] inline bool
+__same_element(const T &a, const T &b) noexcept
+{
+  if constexpr ( __bytewise_comparable<T> )
+    return __builtin_memcmp(&a, &b, sizeof(T)) == 0;
+  else
+    return a == b;
+}
+
+// up to 64 bytes as hex
+inline void
+__print_bytes(const u8 *p, size_t n)
+{
+  constexpr const char *digits = "0123456789abcdef";
+  char buf[3 * 64 + 4];
+  size_t k = 0;
+  for ( size_t i = 0; i < n && i < 64; ++i ) {
+    buf[k++] = digits[p[i] >> 4];
+    buf[k++] = digits[p[i] & 0xf];
+    buf[k++] = ' ';
+  }
+  if ( n > 64 )
+    for ( u32 i = 0; i < 3; ++i ) buf[k++] = '.';
+  buf[k] = 0;
+  __print(static_cast<const char *>(buf));
+}
+
+template <typename T>
+void
+__print_element(const T &v)
+{
+  if constexpr ( micron::is_arithmetic_v<T> ) {
+    __print(v);
+  } else if constexpr ( __bytewise_comparable<T> && !requires { typename T::__snowball_text; } ) {
+    __print_bytes(reinterpret_cast<const u8 *>(&v), sizeof(T));
+  } else if constexpr ( requires { v.data(); v.size(); } ) {
+    if constexpr ( sizeof(*v.data()) == 1 ) {
+      char buf[68];
+      const size_t n = v.size() < 64 ? v.size() : 64;
+      __builtin_memcpy(buf, v.data(), n);
+      // control characters and nuls would garble the report, such strings are shown as hex
+      bool control = false;
+      for ( size_t i = 0; i < n; ++i ) control |= static_cast<u8>(buf[i]) < 0x20 || buf[i] == 0x7f;
+      if ( control ) {
+        __print_bytes(reinterpret_cast<const u8 *>(v.data()), v.size());
+        return;
+      }
+      __builtin_memcpy(buf + n, v.size() > 64 ? "..." : "", v.size() > 64 ? 4 : 1);
+      __print("\"", static_cast<const char *>(buf), "\"");
+    } else {
+      __print_bytes(reinterpret_cast<const u8 *>(v.data()), v.size() * sizeof(*v.data()));
+    }
+  } else {
+    __print("(", sizeof(T), " byte object)");
+  }
+}
+
+template <typename T>
+bool
+__same_elements(const char *who, const T *a, size_t na, const T *b, size_t nb)
+{
+  u64 fa[2] = {}, fb[2] = {};
+  for ( size_t i = 0; i < na; ++i ) {
+    const u64 h = __hash_element(a[i]);
+    fa[0] += h;
+    fa[1] += __mix64(h ^ 0x5851f42d4c957f2dULL);
+  }
+  for ( size_t i = 0; i < nb; ++i ) {
+    const u64 h = __hash_element(b[i]);
+    fb[0] += h;
+    fb[1] += __mix64(h ^ 0x5851f42d4c957f2dULL);
+  }
+  if ( na == nb && fa[0] == fb[0] && fa[1] == fb[1] ) return true;
+
+  struct slot {
+    u64 hash;
+    const T *rep;
+    i64 count;
+  };
+  size_t cap = 16;
+  while ( cap < 2 * (na + nb) ) cap <<= 1;
+  slot *table = new slot[cap]{};
+  auto add = [&](const T &v, i64 d) {
+    const u64 h = __hash_element(v);
+    for ( size_t i = h & (cap - 1);; i = (i + 1) & (cap - 1) ) {
+      if ( table[i].rep == nullptr ) {
+        table[i] = { h, &v, d };
+        return;
+      }
+      if ( table[i].hash == h && __same_element(*table[i].rep, v) ) {
+        table[i].count += d;
+        return;
+      }
+    }
+  };
+  for ( size_t i = 0; i < na; ++i ) add(a[i], 1);
+  for ( size_t i = 0; i < nb; ++i ) add(b[i], -1);
+
+  size_t extra = 0, missing = 0, distinct = 0;
+  for ( size_t i = 0; i < cap; ++i ) {
+    if ( table[i].count > 0 ) extra += static_cast<size_t>(table[i].count);
+    if ( table[i].count < 0 ) missing += static_cast<size_t>(-table[i].count);
+    distinct += table[i].count != 0;
+  }
+  if ( extra == 0 && missing == 0 ) {
+    delete[] table;
+    return true;
+  }
+  __print_error("\033[34msnowball ", who, " failure:\033[0m ", extra, " element(s) only in a, ", missing,
+                " element(s) only in b.\n\r");
+  size_t shown = 0;
+  for ( size_t i = 0; i < cap && shown < config::__default_table_report; ++i ) {
+    if ( table[i].count == 0 ) continue;
+    ++shown;
+    __print(table[i].count > 0 ? "  only in a (x" : "  only in b (x",
+            table[i].count > 0 ? table[i].count : -table[i].count, "): ");
+    __print_element(*table[i].rep);
+    __print("\n\r");
+  }
+  if ( distinct > shown ) __print("  ...\n\r");
+  delete[] table;
+  return false;
+}
+};     // namespace __impl
+
+// a and b hold the same elements with the same multiplicities, in any order
+template <typename A, typename B>
+  requires(__hashable_element<micron::remove_cvref_t<decltype(*__impl::__range_data(micron::declval<const A &>()))>>)
+void
+require_same_elements(const A &a, const B &b)
+{
+  if ( !__impl::__same_elements("require_same_elements()", __impl::__range_data(a), __impl::__range_size(a),
+                                __impl::__range_data(b), __impl::__range_size(b)) ) {
+    should_print_stack();
+    __require_clbck();
+    __abort();
+  }
+}
+
+template <typename A, typename B>
+  requires(__hashable_element<micron::remove_cvref_t<decltype(*__impl::__range_data(micron::declval<const A &>()))>>)
+void
+check_same_elements(const A &a, const B &b)
+{
+  if ( !__impl::__same_elements("check_same_elements()", __impl::__range_data(a), __impl::__range_size(a),
+                                __impl::__range_data(b), __impl::__range_size(b)) ) {
+    should_print_stack();
+    __check_clbck();
+  }
+}
+
+// approximate floating point comparisons
+// distances are in units in the last place, computed on the ordered integer representation so they
+// stay exact under -ffast-math. the array variants run a vectorized pass first and only walk the
+// data again to build the report when something failed
+
+namespace __impl
+{
+template <typename F> struct __float_bits;
+
+template <> struct __float_bits<float> {
+  using type = u32;
+  static constexpr u32 sign = 0x80000000u;
+  static constexpr u32 exponent = 0x7f800000u;
+  static constexpr u32 mantissa = 0x007fffffu;
+};
+
+template <> struct __float_bits<double> {
+  using type = u64;
+  static constexpr u64 sign = 0x8000000000000000ULL;
+  static constexpr u64 exponent = 0x7ff0000000000000ULL;
+  static constexpr u64 mantissa = 0x000fffffffffffffULL;
+};
+
+// +0 and -0 are the same point
+template <typename F>
+[[gnu::always_inline]] inline typename __float_bits<F>::type
+__ulp_bits(F a, F b) noexcept
+{
+  using bits = __float_bits<F>;
+  using U = typename bits::type;
+  const U ua = __builtin_bit_cast(U, a), ub = __builtin_bit_cast(U, b);
+  const U oa = (ua & bits::sign) ? bits::sign - (ua & ~bits::sign) : ua | bits::sign;
+  const U ob = (ub & bits::sign) ? bits::sign - (ub & ~bits::sign) : ub | bits::sign;
+  return oa > ob ? oa - ob : ob - oa;
+}
+
+// checked on the bits, -ffast-math folds isnan() away
+template <typename F>
+[[gnu::always_inline]] inline bool
+__is_nan(F a) noexcept
+{
+  using bits = __float_bits<F>;
+  const typename bits::type u = __builtin_bit_cast(typename bits::type, a);
+  return (u & bits::exponent) == bits::exponent && (u & bits::mantissa);
+}
+
+// nan is infinitely far from everything
+template <typename F>
+[[gnu::always_inline]] inline u64
+__ulp_distance(F a, F b) noexcept
+{
+  return __is_nan(a) || __is_nan(b) ? ~0ULL : static_cast<u64>(__ulp_bits(a, b));
+}
+
+template <typename F>
+[[gnu::always_inline]] inline bool
+__near(F a, F b, typename __float_bits<F>::type max_ulps, F rel_tol) noexcept
+{
+  const F diff = a > b ? a - b : b - a;
+  const F ma = a < F(0) ? -a : a, mb = b < F(0) ? -b : b;
+  const bool close = __ulp_bits(a, b) <= max_ulps || diff <= rel_tol * (ma > mb ? ma : mb);
+  return close & !(__is_nan(a) | __is_nan(b));
+}
+
+inline void
+__print_fixed(double v, u32 decimals = 2)
+{
+  if ( v < 0.0 ) {
+    __print("-");
+    v = -v;
+  }
+  u64 scale = 1;
+  for ( u32 i = 0; i < decimals; ++i ) scale *= 10;
+  u64 fixed = static_cast<u64>(v * static_cast<double>(scale) + 0.5);
+  __print(fixed / scale);
+  if ( decimals == 0 ) return;
+  __print(".");
+  u64 frac = fixed % scale;
+  for ( u64 d = scale / 10; d > 1 && frac < d; d /= 10 ) __print("0");
+  __print(frac);
+}
+
+// scientific notation, 9 significant digits
+inline void
+__print_float(double v)
+{
+  const u64 raw = __builtin_bit_cast(u64, v);
+  if ( (raw & __float_bits<double>::exponent) == __float_bits<double>::exponent ) {
+    __print((raw & __float_bits<double>::mantissa) ? "nan" : (raw >> 63 ? "-inf" : "inf"));
+    return;
+  }
+  if ( raw >> 63 ) {
+    __print("-");
+    v = -v;
+  }
+  if ( !(v > 0.0) ) {
+    __print("0");
+    return;
+  }
+  int e = static_cast<int>(__builtin_floor(__builtin_log10(v)));
+  double m = v / __builtin_pow(10.0, e);
+  if ( m < 1.0 ) {
+    m *= 10.0;
+    --e;
+  }
+  // rounding to 8 decimals may carry into a new digit
+  if ( m * 1e8 + 0.5 >= 1e9 ) {
+    m /= 10.0;
+    ++e;
+  }
+  __print_fixed(m, 8);
+  __print("e", e);
+}
+
+template <typename F>
+size_t
+__count_far(const F *a, const F *b, size_t n, u64 max_ulps, F rel_tol) noexcept
+{
+  using U = typename __float_bits<F>::type;
+  const U max = max_ulps > static_cast<u64>(U(~U(0))) ? U(~U(0)) : static_cast<U>(max_ulps);
+  // counted in lanes as wide as F so the loop vectorizes, over chunks too short for them to wrap
+  constexpr size_t chunk = size_t(1) << 24;
+  size_t far = 0;
+  for ( size_t lo = 0; lo < n; lo += chunk ) {
+    const size_t hi = n - lo < chunk ? n : lo + chunk;
+    U part = 0;
+#pragma omp simd reduction(+ : part)
+    for ( size_t i = lo; i < hi; ++i ) part += !__near(a[i], b[i], max, rel_tol);
+    far += part;
+  }
+  return far;
+}
+
+template <typename F>
+void
+__near_report(const char *who, const F *a, const F *b, size_t n, size_t far, u64 max_ulps, F rel_tol)
+{
+  // bucket 0 is exact, bucket k holds [2^(k-1), 2^k) ulps, the last one nan
+  u64 hist[66] = {};
+  size_t worst = 0;
+  u64 worst_ulps = 0;
+  double max_abs = 0.0;
+  for ( size_t i = 0; i < n; ++i ) {
+    const u64 d = __ulp_distance(a[i], b[i]);
+    hist[d == ~0ULL ? 65 : (d ? 64 - __builtin_clzll(d) : 0)]++;
+    if ( d > worst_ulps ) {
+      worst_ulps = d;
+      worst = i;
+    }
+    const double diff = static_cast<double>(a[i]) - static_cast<double>(b[i]);
+    if ( d != ~0ULL && (diff < 0.0 ? -diff : diff) > max_abs ) max_abs = diff < 0.0 ? -diff : diff;
+  }
+  __print_error("\033[34msnowball ", who, " failure:\033[0m ", far, " of ", n, " elements not within ", max_ulps,
+                " ulps (rel tol ");
+  __print_float(static_cast<double>(rel_tol));
+  __print(").\n\r  worst at index ", worst, ": a = ");
+  __print_float(static_cast<double>(a[worst]));
+  __print(", b = ");
+  __print_float(static_cast<double>(b[worst]));
+  if ( worst_ulps == ~0ULL )
+    __print(", nan\n\r");
+  else
+    __print(", ", worst_ulps, " ulps\n\r");
+  __print("  max abs error: ");
+  __print_float(max_abs);
+  __print("\n\r  ulp histogram:");
+  for ( u32 k = 0; k < 66; ++k ) {
+    if ( !hist[k] ) continue;
+    if ( k == 0 )
+      __print(" [0]");
+    else if ( k == 65 )
+      __print(" [nan]");
+    else if ( k == 1 )
+      __print(" [1]");
+    else
+      __print(" [", 1ULL << (k - 1), "-", (k == 64 ? ~0ULL : (1ULL << k) - 1), "]");
+    __print(" ", hist[k]);
+  }
+  __print("\n\r");
+}
+
+template <typename F>
+bool
+__all_near(const char *who, const F *a, size_t na, const F *b, size_t nb, u64 max_ulps, double rel_tol)
+{
+  if ( na != nb ) {
+    __print_error("\033[34msnowball ", who, " failure:\033[0m ranges differ in length (", na, " vs ", nb, ").\n\r");
+    return false;
+  }
+  const F tol = static_cast<F>(rel_tol);
+  const size_t far = __count_far(a, b, na, max_ulps, tol);
+  if ( far ) __near_report(who, a, b, na, far, max_ulps, tol);
+  return far == 0;
+}
+};     // namespace __impl
+
+template <typename F>
+  requires(micron::is_floating_point_v<F>)
+void
+require_near(const F a, const F b, u64 max_ulps = config::__default_max_ulps)
+{
+  if ( !__impl::__all_near("require_near()", &a, 1, &b, 1, max_ulps, 0.0) ) {
+    should_print_stack();
+    __require_clbck();
+    __abort();
+  }
+}
+
+template <typename F>
+  requires(micron::is_floating_point_v<F>)
+void
+check_near(const F a, const F b, u64 max_ulps = config::__default_max_ulps)
+{
+  if ( !__impl::__all_near("check_near()", &a, 1, &b, 1, max_ulps, 0.0) ) {
+    should_print_stack();
+    __check_clbck();
+  }
+}
+
+// elements match if within max_ulps, or within rel_tol relative to the larger magnitude
+template <typename A, typename B>
+void
+require_all_near(const A &a, const B &b, u64 max_ulps = config::__default_max_ulps, double rel_tol = 0.0)
+{
+  if ( !__impl::__all_near("require_all_near()", __impl::__range_data(a), __impl::__range_size(a),
+                           __impl::__range_data(b), __impl::__range_size(b), max_ulps, rel_tol) ) {
+    should_print_stack();
+    __require_clbck();
+    __abort();
+  }
+}
+
+template <typename A, typename B>
+void
+check_all_near(const A &a, const B &b, u64 max_ulps = config::__default_max_ulps, double rel_tol = 0.0)
+{
+  if ( !__impl::__all_near("check_all_near()", __impl::__range_data(a), __impl::__range_size(a),
+                           __impl::__range_data(b), __impl::__range_size(b), max_ulps, rel_tol) ) {
+    should_print_stack();
+    __check_clbck();
+  }
+}
+
+// parallel range predicates
+// require_all(range, pred) / require_none(range, pred) evaluate pred on every element, in blocks
+// spread over all cores with OpenMP. each block counts its failures and keeps its first few; these are
+// merged so the report lists the smallest failing indices in order, whatever the schedule was
+
+namespace __impl
+{
+// the smallest failing indices seen so far, in order
+struct __first_misses {
+  u64 index[config::__default_table_report];
+  u32 count = 0;
+
+  void
+  merge(const u64 *found, u32 n) noexcept
+  {
+    for ( u32 k = 0; k < n; ++k ) {
+      u32 at = count;
+      while ( at && index[at - 1] > found[k] ) --at;
+      if ( at == config::__default_table_report ) break;
+      const u32 last = count < config::__default_table_report ? count : count - 1;
+      for ( u32 j = last; j > at; --j ) index[j] = index[j - 1];
+      index[at] = found[k];
+      if ( count < config::__default_table_report ) ++count;
+    }
+  }
+};
+
+template <typename T, typename Pred>
+bool
+__all_of(const char *who, const T *p, size_t n, Pred &pred, bool expect)
+{
+  constexpr size_t block = 4096;
+  const size_t blocks = (n + block - 1) / block;
+  u64 failures = 0;
+  __first_misses first;
+#pragma omp parallel for schedule(dynamic, 4) reduction(+ : failures) if ( blocks > 1 )
+  for ( size_t b = 0; b < blocks; ++b ) {
+    const size_t lo = b * block;
+    const size_t hi = n - lo < block ? n : lo + block;
+    u64 bad = 0;
+    for ( size_t i = lo; i < hi; ++i ) bad += static_cast<bool>(pred(p[i])) != expect;
+    if ( bad == 0 ) continue;
+    // only a failing block is walked again to find where
+    u64 found[config::__default_table_report];
+    u32 nfound = 0;
+    for ( size_t i = lo; i < hi && nfound < config::__default_table_report; ++i )
+      if ( static_cast<bool>(pred(p[i])) != expect ) found[nfound++] = i;
+    failures += bad;
+#pragma omp critical(snowball_all_of)
+    first.merge(found, nfound);
+  }
+  if ( failures == 0 ) return true;
+
+  __print_error("\033[34msnowball ", who, " failure:\033[0m ", failures, " of ", n,
+                expect ? " elements failed the predicate" : " elements matched the predicate");
+  __print(failures > first.count ? ", the first ones:\n\r" : ":\n\r");
+  for ( u32 k = 0; k < first.count; ++k ) {
+    __print("  [", first.index[k], "]: ");
+    __print_element(p[first.index[k]]);
+    __print("\n\r");
+  }
+  return false;
+}
+};     // namespace __impl
+
+// every element satisfies pred
+template <typename T, typename Pred>
+void
+require_all(const T *p, size_t n, Pred &&pred)
+{
+  if ( !__impl::__all_of("require_all()", p, n, pred, true) ) {
+    should_print_stack();
+    __require_clbck();
+    __abort();
+  }
+}
+
+template <typename R, typename Pred>
+void
+require_all(const R &r, Pred &&pred)
+{
+  require_all(__impl::__range_data(r), __impl::__range_size(r), pred);
+}
+
+template <typename T, typename Pred>
+void
+check_all(const T *p, size_t n, Pred &&pred)
+{
+  if ( !__impl::__all_of("check_all()", p, n, pred, true) ) {
+    should_print_stack();
+    __check_clbck();
+  }
+}
+
+template <typename R, typename Pred>
+void
+check_all(const R &r, Pred &&pred)
+{
+  check_all(__impl::__range_data(r), __impl::__range_size(r), pred);
+}
+
+// no element satisfies pred
+template <typename T, typename Pred>
+void
+require_none(const T *p, size_t n, Pred &&pred)
+{
+  if ( !__impl::__all_of("require_none()", p, n, pred, false) ) {
+    should_print_stack();
+    __require_clbck();
+    __abort();
+  }
+}
+
+template <typename R, typename Pred>
+void
+require_none(const R &r, Pred &&pred)
+{
+  require_none(__impl::__range_data(r), __impl::__range_size(r), pred);
+}
+
+template <typename T, typename Pred>
+void
+check_none(const T *p, size_t n, Pred &&pred)
+{
+  if ( !__impl::__all_of("check_none()", p, n, pred, false) ) {
+    should_print_stack();
+    __check_clbck();
+  }
+}
+
+template <typename R, typename Pred>
+void
+check_none(const R &r, Pred &&pred)
+{
+  check_none(__impl::__range_data(r), __impl::__range_size(r), pred);
+}
+
+// keeps a function out of -fsanitize-coverage instrumentation; the coverage and comparison hooks,
+// and everything they call, carry it so a hook never re-enters itself
+#if defined(__clang__)
+#define __snowball_no_coverage __attribute__((no_sanitize("coverage")))
+#elif defined(__has_attribute) && __has_attribute(no_sanitize_coverage)
+#define __snowball_no_coverage __attribute__((no_sanitize_coverage))
+#else
+#define __snowball_no_coverage
+#endif
+
+namespace __impl
+{
+inline u64
+__xorshift64(u64 &s)
+{
+  s ^= s << 13;
+  s ^= s >> 7;
+  s ^= s << 17;
+  return s;
+}
+
+[[gnu::always_inline]] inline u64
+__cycle_counter() noexcept
+{
+#if defined(__micron_arch_amd64)
+  u32 lo = 0, hi = 0;
+  asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
+  return (u64(hi) << 32) | u64(lo);
+#elif defined(__micron_arch_arm64)
+  u64 v;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(v));
+  return v;
+#elif defined(__micron_arch_arm32)
+  u32 lo, hi;
+  asm volatile("mrrc p15, 1, %0, %1, c14" : "=r"(lo), "=r"(hi));
+  return (u64(hi) << 32) | u64(lo);
+#else
+  return 0;
+#endif
+}
+
+__snowball_no_coverage inline u64
+__now_ns() noexcept
+{
+  struct timespec ts;
+  ::clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<u64>(ts.tv_sec) * 1000000000ULL + static_cast<u64>(ts.tv_nsec);
+}
+
+// heapsort, no allocation and no recursion
+template <typename T, typename Cmp>
+void
+__sort(T *arr, size_t n, Cmp &&less)
+{
+  auto sift = [&](size_t root, size_t end) {
+    for ( ;; ) {
+      size_t child = 2 * root + 1;
+      if ( child >= end ) return;
+      if ( child + 1 < end && less(arr[child], arr[child + 1]) ) ++child;
+      if ( !less(arr[root], arr[child]) ) return;
+      T tmp = micron::move(arr[root]);
+      arr[root] = micron::move(arr[child]);
+      arr[child] = micron::move(tmp);
+      root = child;
+    }
+  };
+  if ( n < 2 ) return;
+  for ( size_t i = n / 2; i-- > 0; ) sift(i, n);
+  for ( size_t end = n - 1; end > 0; --end ) {
+    T tmp = micron::move(arr[0]);
+    arr[0] = micron::move(arr[end]);
+    arr[end] = micron::move(tmp);
+    sift(0, end);
+  }
+}
+
+template <typename T>
+void
+__sort(T *arr, size_t n)
+{
+  __sort(arr, n, [](const T &a, const T &b) { return a < b; });
+}
+
+inline u64 __fuzz_state = 0;
+inline bool __fuzz_drawn = false;     // set by every draw, so test_case() knows which cases fuzzed
+
+inline u64
+__fuzz_next() noexcept
+{
+  __atomic_store_n(&__fuzz_drawn, true, __ATOMIC_RELAXED);
+  if ( __fuzz_state == 0 ) {
+    __fuzz_state = __global_fuzz_seed ? __global_fuzz_seed : __cycle_counter();
+    if ( __fuzz_state == 0 ) __fuzz_state = 0xdeadbeefULL;
+  }
+  return __xorshift64(__fuzz_state);
+}
+};     // namespace __impl
+
+// fuzzing statistics
+// fuzz loops publish into a fuzz_stats block: executions in batches, crashes, dictionary size and,
+// with -fsanitize-coverage=trace-pc-guard (clang) or trace-pc (gcc), reached edges. every field is
+// written with relaxed atomics. the block lives in process memory, or in a shared file mapping after
+// stats_file(path) / --stats=path, so other processes can watch a running job by mapping the same
+// file. with fuzz_status(seconds) / --status=seconds the fuzz loops also print a status line
+struct fuzz_stats {
+  static constexpr u64 magic_value = 0x5354415442534253ULL;     // "SBSBTATS"
+
+  u64 magic;
+  u32 version;
+  u32 pid;
+  u64 start_ns;       // CLOCK_MONOTONIC
+  u64 execs;
+  u64 crashes;
+  u64 corpus;         // inputs kept as interesting
+  u64 dictionary;     // comparison operands collected
+  u64 edges;          // distinct edges reached
+  u64 edges_total;    // instrumented edges
+  u64 last_new_ns;    // last new edge, corpus entry or crash
+  char target[64];    // test case being fuzzed
+};
+
+namespace __impl
+{
+inline fuzz_stats __local_stats{ fuzz_stats::magic_value, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, {} };
+inline fuzz_stats *__stats = &__local_stats;
+inline u32 __status_seconds = 0;
+inline u64 __edge_ids = 0;
+
+template <typename T>
+[[gnu::always_inline]] __snowball_no_coverage inline void
+__stat_add(u64 fuzz_stats::*field, T v)
+{
+  __atomic_fetch_add(&(__stats->*field), static_cast<u64>(v), __ATOMIC_RELAXED);
+}
+
+[[gnu::always_inline]] __snowball_no_coverage inline void
+__stat_set(u64 fuzz_stats::*field, u64 v)
+{
+  __atomic_store_n(&(__stats->*field), v, __ATOMIC_RELAXED);
+}
+
+[[gnu::always_inline]] __snowball_no_coverage inline u64
+__stat(u64 fuzz_stats::*field)
+{
+  return __atomic_load_n(&(__stats->*field), __ATOMIC_RELAXED);
+}
+
+// counts executions locally and publishes them every 256, printing the status line when due
+inline void
+__stat_target(const char *name)
+{
+  size_t i = 0;
+  for ( ; name && name[i] && i + 1 < sizeof(fuzz_stats::target); ++i ) __stats->target[i] = name[i];
+  __stats->target[i] = 0;
+}
+
+struct __fuzz_meter {
+  u64 pending = 0;
+  u64 last_ns;
+  u64 last_execs;
+
+  __fuzz_meter() : last_ns(__now_ns()), last_execs(__stat(&fuzz_stats::execs))
+  {
+    if ( __stat(&fuzz_stats::start_ns) == 0 ) __stat_set(&fuzz_stats::start_ns, last_ns);
+    __stat_target(__atomic_load_n(&__global_case_name, __ATOMIC_ACQUIRE));
+  }
+  ~__fuzz_meter() { flush(); }
+  __fuzz_meter(const __fuzz_meter &) = delete;
+  __fuzz_meter &operator=(const __fuzz_meter &) = delete;
+
+  [[gnu::always_inline]] void
+  tick(void)
+  {
+    if ( ++pending == 256 ) [[unlikely]]
+      flush();
+  }
+
+  void
+  flush(void)
+  {
+    __stat_add(&fuzz_stats::execs, pending);
+    pending = 0;
+    if ( __status_seconds == 0 ) return;
+    const u64 now = __now_ns();
+    if ( now - last_ns < __status_seconds * 1000000000ULL ) return;
+    const u64 execs = __stat(&fuzz_stats::execs);
+    u64 last_new = __stat(&fuzz_stats::last_new_ns);
+    if ( last_new == 0 || last_new > now ) last_new = last_new ? now : __stat(&fuzz_stats::start_ns);
+    __print("\033[34msnowball fuzz:\033[0m ", execs, " execs (");
+    __print_fixed(static_cast<double>(execs - last_execs) * 1e9 / static_cast<double>(now - last_ns), 0);
+    __print("/s), edges ", __stat(&fuzz_stats::edges));
+    if ( const u64 total = __stat(&fuzz_stats::edges_total) ) __print("/", total);
+    __print(", corpus ", __stat(&fuzz_stats::corpus), ", dict ", __stat(&fuzz_stats::dictionary), ", crashes ",
+            __stat(&fuzz_stats::crashes), ", last new ");
+    __print_fixed(static_cast<double>(now - last_new) / 1e9, 1);
+    __print("s ago\n\r");
+    last_ns = now;
+    last_execs = execs;
+  }
+};
+
+extern "C" {
+// numbers every guard once, 0 marks an edge already reached
+[[gnu::weak]] __snowball_no_coverage void
+__sanitizer_cov_trace_pc_guard_init(__UINT32_TYPE__ *start, __UINT32_TYPE__ *stop)
+{
+  if ( start == stop || *start ) return;
+  for ( __UINT32_TYPE__ *g = start; g < stop; ++g ) *g = static_cast<__UINT32_TYPE__>(++__edge_ids);
+  __stat_set(&fuzz_stats::edges_total, __edge_ids);
+}
+
+// each edge reports once and is then switched off, so reached code costs a load and a branch
+[[gnu::weak]] __snowball_no_coverage void
+__sanitizer_cov_trace_pc_guard(__UINT32_TYPE__ *guard)
+{
+  if ( *guard == 0 ) return;
+  *guard = 0;
+  __stat_add(&fuzz_stats::edges, 1);
+  __stat_set(&fuzz_stats::last_new_ns, __now_ns());
+}
+}
+
+// gcc only has -fsanitize-coverage=trace-pc, without guards: block addresses are hashed into a bitmap,
+// so edges counts there may come out slightly low, and the total is unknown
+inline u64 __pc_map[1 << 13];
+
+extern "C" {
+[[gnu::weak]] __snowball_no_coverage void
+__sanitizer_cov_trace_pc(void)
+{
+  const umax_t pc = reinterpret_cast<umax_t>(__builtin_return_address(0));
+  const u64 h = (static_cast<u64>(pc) * 0x9e3779b97f4a7c15ULL) >> (64 - 19);
+  u64 &word = __pc_map[h >> 6];
+  const u64 bit = 1ULL << (h & 63);
+  if ( word & bit ) [[likely]]
+    return;
+  word |= bit;
+  __stat_add(&fuzz_stats::edges, 1);
+  __stat_set(&fuzz_stats::last_new_ns, __now_ns());
+}
+}
+};     // namespace __impl
+
+// publishes fuzzing statistics through a shared mapping of path, see fuzz_stats
+inline void
+stats_file(const char *path)
+{
+  const int fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if ( fd < 0 || ::ftruncate(fd, sizeof(fuzz_stats)) != 0 ) error("stats_file(): couldn't create the statistics file");
+  void *p = ::mmap(nullptr, sizeof(fuzz_stats), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if ( p == MAP_FAILED ) error("stats_file(): couldn't map the statistics file");
+  fuzz_stats *mapped = static_cast<fuzz_stats *>(p);
+  __builtin_memcpy(mapped, __impl::__stats, sizeof(fuzz_stats));
+  mapped->pid = static_cast<u32>(::getpid());
+  __atomic_store_n(&__impl::__stats, mapped, __ATOMIC_RELEASE);
+}
+
+// fuzz loops print a status line every seconds, 0 turns it off
+inline void
+fuzz_status(u32 seconds)
+{
+  __impl::__status_seconds = seconds;
+}
+
+// the statistics of this process so far
+inline const fuzz_stats &
+stats(void)
+{
+  return *__impl::__stats;
+}
+
+// crash recovery
+// while fuzz() runs an input, SIGSEGV/SIGBUS/SIGFPE/SIGILL/SIGABRT are caught on an alternate stack.
+// the handler only formats into the per thread report buffer and calls write/open/close: it reports
+// the input, test case and the stack from the faulting frame, saves the input as <crash dir>/crash-<hash>
+// and, for faults raised by the faulting instruction itself, siglongjmps back into the fuzz loop, which
+// carries on with the next input. memory or locks the crashed call held are lost. anything else
+// (abort(), signals sent by kill, crashes outside the loop) is reported and then left to the previous
+// handler or the default action. crashes with the same signal and innermost frames as an earlier one
+// are only counted
+namespace __impl
+{
+struct __crash_ctx {
+  sigjmp_buf env;
+  const void *input;
+  size_t input_size;
+  size_t index;
+  u64 crashes;
+  u64 seen[config::__default_buckets];     // keys of the distinct crashes reported so far
+  u32 distinct;
+  volatile sig_atomic_t armed;
+  volatile sig_atomic_t in_handler;
+};
+
+[[gnu::tls_model("initial-exec")]] inline thread_local __crash_ctx *__tls_crash = nullptr;
+
+inline constexpr int __crash_signals[] = { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT };
+inline struct sigaction __crash_previous[sizeof(__crash_signals) / sizeof(int)];
+
+inline const char *
+__signal_name(int sig)
+{
+  switch ( sig ) {
+  case SIGSEGV :
+    return "SIGSEGV";
+  case SIGBUS :
+    return "SIGBUS";
+  case SIGFPE :
+    return "SIGFPE";
+  case SIGILL :
+    return "SIGILL";
+  case SIGABRT :
+    return "SIGABRT";
+  default :
+    return "signal";
+  }
+}
+
+inline void
+__stage_hex(__stage &st, const void *p, size_t n)
+{
+  const u8 *b = static_cast<const u8 *>(p);
+  for ( size_t i = 0; i < n; ++i ) {
+    const char h[3] = { "0123456789abcdef"[b[i] >> 4], "0123456789abcdef"[b[i] & 15], ' ' };
+    __stage_write(st, h, 3);
+  }
+}
+
+// <crash dir>/crash-<16 hex digits>, written with open/write only
+inline void
+__persist_crash(const void *input, size_t n, char *path, size_t cap, const char *prefix = "crash-")
+{
+  size_t len = 0;
+  auto put = [&](const char *str) {
+    while ( *str && len + 1 < cap ) path[len++] = *str++;
+  };
+  if ( __global_crash_dir ) {
+    put(__global_crash_dir);
+    put("/");
+  }
+  put(prefix);
+  const u64 h = __hash_bytes(input, n);
+  for ( int i = 60; i >= 0 && len + 1 < cap; i -= 4 ) path[len++] = "0123456789abcdef"[(h >> i) & 15];
+  path[len] = 0;
+  const int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if ( fd < 0 ) {
+    path[0] = 0;
+    return;
+  }
+  const u8 *p = static_cast<const u8 *>(input);
+  while ( n ) {
+    const ssize_t w = ::write(fd, p, n);
+    if ( w <= 0 ) break;
+    p += w;
+    n -= static_cast<size_t>(w);
+  }
+  ::close(fd);
+}
+
+// failures are bucketed by a key over what failed and the innermost few frames where it happened
+inline u64
+__bucket_key(u64 what, void *const *frames, int n) noexcept
+{
+  u64 h = __mix64(what + 0x9e3779b97f4a7c15ULL);
+  for ( int i = 0; i < n && i < static_cast<int>(config::__default_bucket_frames); ++i )
+    h = __mix64(h ^ reinterpret_cast<umax_t>(frames[i]));
+  return h;
+}
+
+// true if key was already in seen[0..count), otherwise records it (while there's room)
+inline bool
+__bucket_seen(u64 *seen, u32 &count, u64 key) noexcept
+{
+  for ( u32 i = 0; i < count; ++i )
+    if ( seen[i] == key ) return true;
+  if ( count < config::__default_buckets ) seen[count++] = key;
+  return false;
+}
+
+inline void
+__report_crash(const __crash_ctx *ctx, int sig, const siginfo_t *info, void *const *frames, int n)
+{
+  __stage &st = __tls_stage;
+  st.active = false;     // drop whatever a report in progress had staged
+  st.len = 0;
+  __report_begin();
+  __print("\033[34msnowball fuzz() crash:\033[0m ", __signal_name(sig), " (code ", info->si_code, ", address ",
+          info->si_addr, ") on input ", ctx->index, "\n\r  input bytes: ");
+  if ( ctx->input_size > 256 ) {
+    __stage_hex(st, ctx->input, 256);
+    __print("... (", ctx->input_size, " bytes)");
+  } else {
+    __stage_hex(st, ctx->input, ctx->input_size);
+  }
+  char path[512];
+  __persist_crash(ctx->input, ctx->input_size, path, sizeof(path));
+  if ( path[0] )
+    __print("\n\r  reproducer: ", static_cast<const char *>(path), "\n\r");
+  else
+    __print("\n\r  reproducer: couldn't be written\n\r");
+#if !defined(__micron_arch_arm32)
+  if constexpr ( config::__default_print_stack ) __print_frames(frames, n);
+#else
+  (void)frames;
+  (void)n;
+#endif
+  __report_end();
+}
+
+inline void
+__crash_handler(int sig, siginfo_t *info, void *ucontext)
+{
+  __crash_ctx *ctx = __tls_crash;
+  if ( ctx == nullptr || !ctx->armed || ctx->in_handler ) {
+    // not ours, or we crashed while reporting: hand it back
+    for ( size_t i = 0; i < sizeof(__crash_signals) / sizeof(int); ++i )
+      if ( __crash_signals[i] == sig ) ::sigaction(sig, &__crash_previous[i], nullptr);
+    if ( info->si_code <= 0 ) ::raise(sig);     // sent rather than raised by a fault, won't recur
+    return;
+  }
+  ctx->in_handler = 1;
+  ++ctx->crashes;
+  __stat_add(&fuzz_stats::crashes, 1);
+  __atomic_fetch_add(&__global_failures, 1, __ATOMIC_RELAXED);
+
+  constexpr int max_frames = 64;
+  void *frames[max_frames];
+  int n = 0;
+#if !defined(__micron_arch_arm32)
+  const ucontext_t *uc = static_cast<const ucontext_t *>(ucontext);
+#if defined(__micron_arch_amd64)
+  frames[n++] = reinterpret_cast<void *>(uc->uc_mcontext.gregs[REG_RIP]);
+  n += __walk_frames(reinterpret_cast<void **>(uc->uc_mcontext.gregs[REG_RBP]), frames + n, max_frames - n);
+#elif defined(__micron_arch_arm64)
+  frames[n++] = reinterpret_cast<void *>(uc->uc_mcontext.pc);
+  n += __walk_frames(reinterpret_cast<void **>(uc->uc_mcontext.regs[29]), frames + n, max_frames - n);
+#else
+  (void)uc;
+#endif
+#else
+  (void)ucontext;
+#endif
+  // the same signal at the same few innermost frames is the same bug, reported once
+  if ( !__bucket_seen(ctx->seen, ctx->distinct, __bucket_key(static_cast<u64>(sig), frames, n)) ) {
+    __stat_set(&fuzz_stats::last_new_ns, __now_ns());
+    __report_crash(ctx, sig, info, frames, n);
+  }
+  ctx->in_handler = 0;
+
+  // a fault of the current instruction unwinds cleanly; abort() may hold libc locks
+  if ( sig != SIGABRT && info->si_code > 0 ) siglongjmp(ctx->env, 1);
+  ctx->armed = 0;
+  for ( size_t i = 0; i < sizeof(__crash_signals) / sizeof(int); ++i )
+    if ( __crash_signals[i] == sig ) ::sigaction(sig, &__crash_previous[i], nullptr);
+  ::raise(sig);
+}
+
+inline thread_local u8 *__tls_altstack = nullptr;
+
+// installs the handler for the lifetime of the guard, restoring the previous handlers after
+struct __crash_guard {
+  __crash_ctx ctx{};
+  __crash_ctx *outer;
+
+  __crash_guard(const void *input, size_t size) : outer(__tls_crash)
+  {
+    ctx.input = input;
+    ctx.input_size = size;
+    stack_t current{};
+    ::sigaltstack(nullptr, &current);
+    if ( (current.ss_flags & SS_DISABLE) && __tls_altstack == nullptr ) {
+      constexpr size_t size_alt = 1 << 16;
+      __tls_altstack = new u8[size_alt];
+      stack_t alt{};
+      alt.ss_sp = __tls_altstack;
+      alt.ss_size = size_alt;
+      ::sigaltstack(&alt, nullptr);
+    }
+    __tls_crash = &ctx;
+    if ( outer == nullptr ) {
+      struct sigaction sa{};
+      sa.sa_sigaction = &__crash_handler;
+      sa.sa_flags = SA_SIGINFO | SA_ONSTACK | SA_NODEFER;
+      ::sigemptyset(&sa.sa_mask);
+      for ( size_t i = 0; i < sizeof(__crash_signals) / sizeof(int); ++i )
+        ::sigaction(__crash_signals[i], &sa, &__crash_previous[i]);
+    }
+  }
+
+  ~__crash_guard()
+  {
+    ctx.armed = 0;
+    __tls_crash = outer;
+    if ( outer == nullptr )
+      for ( size_t i = 0; i < sizeof(__crash_signals) / sizeof(int); ++i )
+        ::sigaction(__crash_signals[i], &__crash_previous[i], nullptr);
+  }
+
+  __crash_guard(const __crash_guard &) = delete;
+  __crash_guard &operator=(const __crash_guard &) = delete;
+
+  // fails like require() if anything crashed
+  void
+  finish(size_t inputs)
+  {
+    ctx.armed = 0;
+    if ( ctx.crashes == 0 ) return;
+    __print_error("\033[34msnowball fuzz() failure:\033[0m ", ctx.crashes, " of ", inputs, " inputs crashed, ",
+                  ctx.distinct, " distinct.\n\r");
+    __require_clbck();
+    __abort();
+  }
+};
+};     // namespace __impl
+
+// comparison tracing
+// while fuzz() runs, operands of comparisons in code built with -fsanitize-coverage=trace-cmp, and
+// the buffers passed to memcmp/strcmp/strncmp when a sanitizer runtime intercepts those, are
+// collected into a per run dictionary. the mutator splices dictionary entries into inputs, so magic
+// numbers and headers compared against the input get matched without having to be guessed.
+// the memcmp/strcmp/strncmp hooks are only called by a sanitizer's interceptors, so without a
+// sanitizer runtime (or for calls the compiler expanded inline) no buffer operands are collected.
+// the hooks are weak, a fuzzing runtime linked in takes precedence
+
+namespace __impl
+{
+struct __dict_entry {
+  u8 len;
+  u8 bytes[32];
+};
+
+// compile time constants are kept for the whole run; operands that both vary, which are mostly
+// input derived, go into a ring of recent ones
+struct __cmplog {
+  static constexpr u32 constants = 512;
+  static constexpr u32 recent = 512;
+  static constexpr u32 slots = 2048;     // fingerprints of the constants, for dedup
+
+  __dict_entry entries[constants + recent];
+  u64 seen[slots];
+  u32 count;     // constants
+  u32 ring;      // recent entries written so far
+};
+
+[[gnu::tls_model("initial-exec")]] inline thread_local __cmplog *__tls_cmplog = nullptr;
+
+// no allocation and nothing instrumented, called from the hooks; once the constants are full new
+// ones are dropped
+[[gnu::always_inline]] __snowball_no_coverage inline void
+__cmplog_add(const void *p, size_t n, bool constant)
+{
+  __cmplog *log = __tls_cmplog;
+  if ( log == nullptr || n == 0 ) return;
+  if ( n > sizeof(__dict_entry::bytes) ) n = sizeof(__dict_entry::bytes);
+  const u8 *b = static_cast<const u8 *>(p);
+  __dict_entry *e;
+  if ( constant ) {
+    if ( log->count == __cmplog::constants ) return;
+    u64 h = 0xcbf29ce484222325ULL ^ n;
+    for ( size_t i = 0; i < n; ++i ) h = (h ^ b[i]) * 0x100000001b3ULL;
+    h |= 1;
+    for ( u32 i = static_cast<u32>(h) & (__cmplog::slots - 1);; i = (i + 1) & (__cmplog::slots - 1) ) {
+      if ( log->seen[i] == h ) return;
+      if ( log->seen[i] == 0 ) {
+        log->seen[i] = h;
+        break;
+      }
+    }
+    e = &log->entries[log->count++];
+    __stat_add(&fuzz_stats::dictionary, 1);
+  } else {
+    e = &log->entries[__cmplog::constants + log->ring++ % __cmplog::recent];
+  }
+  e->len = static_cast<u8>(n);
+  __builtin_memcpy(e->bytes, b, n);
+}
+
+template <typename T>
+[[gnu::always_inline]] __snowball_no_coverage inline void
+__cmplog_pair(T a, T b)
+{
+  if ( __tls_cmplog == nullptr || a == b ) return;
+  __cmplog_add(&a, sizeof(T), false);
+  __cmplog_add(&b, sizeof(T), false);
+}
+
+// a is the compile time constant
+template <typename T>
+[[gnu::always_inline]] __snowball_no_coverage inline void
+__cmplog_const(T a, T b)
+{
+  if ( __tls_cmplog == nullptr || a == b ) return;
+  __cmplog_add(&a, sizeof(T), true);
+}
+
+[[gnu::always_inline]] __snowball_no_coverage inline void
+__cmplog_str(const char *a, const char *b, size_t n)
+{
+  if ( __tls_cmplog == nullptr ) return;
+  size_t la = 0, lb = 0;
+  while ( la < n && la < sizeof(__dict_entry::bytes) && a[la] ) ++la;
+  while ( lb < n && lb < sizeof(__dict_entry::bytes) && b[lb] ) ++lb;
+  __cmplog_add(a, la, false);
+  __cmplog_add(b, lb, false);
+}
+
+// overwrites part of data with a dictionary entry, if there is one
+inline bool
+__cmplog_splice(u8 *data, size_t n, u64 &state)
+{
+  __cmplog *log = __tls_cmplog;
+  if ( log == nullptr || n == 0 ) return false;
+  const u32 recent = log->ring < __cmplog::recent ? log->ring : __cmplog::recent;
+  if ( log->count + recent == 0 ) return false;
+  u32 pick = static_cast<u32>(__xorshift64(state) % (log->count + recent));
+  if ( pick >= log->count ) pick = __cmplog::constants + (pick - log->count);
+  const __dict_entry &e = log->entries[pick];
+  const size_t len = e.len < n ? e.len : n;
+  const size_t at = __xorshift64(state) % (n - len + 1);
+  __builtin_memcpy(data + at, e.bytes, len);
+  return true;
+}
+
+// collects comparison operands on this thread for the lifetime of the scope
+struct __cmplog_scope {
+  __cmplog *log;
+  __cmplog *outer;
+
+  __cmplog_scope() : log(new __cmplog), outer(__tls_cmplog)
+  {
+    log->count = 0;
+    log->ring = 0;
+    __builtin_memset(log->seen, 0, sizeof(log->seen));
+    __tls_cmplog = log;
+  }
+  ~__cmplog_scope()
+  {
+    __tls_cmplog = outer;
+    delete log;
+  }
+  __cmplog_scope(const __cmplog_scope &) = delete;
+  __cmplog_scope &operator=(const __cmplog_scope &) = delete;
+};
+
+extern "C" {
+[[gnu::weak]] __snowball_no_coverage void
+__sanitizer_cov_trace_cmp1(__UINT8_TYPE__ a, __UINT8_TYPE__ b)
+{
+  __cmplog_pair(a, b);
+}
+
+[[gnu::weak]] __snowball_no_coverage void
+__sanitizer_cov_trace_cmp2(__UINT16_TYPE__ a, __UINT16_TYPE__ b)
+{
+  __cmplog_pair(a, b);
+}
+
+[[gnu::weak]] __snowball_no_coverage void
+__sanitizer_cov_trace_cmp4(__UINT32_TYPE__ a, __UINT32_TYPE__ b)
+{
+  __cmplog_pair(a, b);
+}
+
+[[gnu::weak]] __snowball_no_coverage void
+__sanitizer_cov_trace_cmp8(__UINT64_TYPE__ a, __UINT64_TYPE__ b)
+{
+  __cmplog_pair(a, b);
+}
+
+// gcc also traces floating point comparisons, which carry nothing worth splicing
+[[gnu::weak]] __snowball_no_coverage void
+__sanitizer_cov_trace_cmpf(float, float)
+{
+}
+
+[[gnu::weak]] __snowball_no_coverage void
+__sanitizer_cov_trace_cmpd(double, double)
+{
+}
+
+[[gnu::weak]] __snowball_no_coverage void
+__sanitizer_cov_trace_const_cmp1(__UINT8_TYPE__ a, __UINT8_TYPE__ b)
+{
+  __cmplog_const(a, b);
+}
+
+[[gnu::weak]] __snowball_no_coverage void
+__sanitizer_cov_trace_const_cmp2(__UINT16_TYPE__ a, __UINT16_TYPE__ b)
+{
+  __cmplog_const(a, b);
+}
+
+[[gnu::weak]] __snowball_no_coverage void
+__sanitizer_cov_trace_const_cmp4(__UINT32_TYPE__ a, __UINT32_TYPE__ b)
+{
+  __cmplog_const(a, b);
+}
+
+[[gnu::weak]] __snowball_no_coverage void
+__sanitizer_cov_trace_const_cmp8(__UINT64_TYPE__ a, __UINT64_TYPE__ b)
+{
+  __cmplog_const(a, b);
+}
+
+// cases[0] is the number of cases, cases[1] their width in bits
+[[gnu::weak]] __snowball_no_coverage void
+__sanitizer_cov_trace_switch(__UINT64_TYPE__ val, __UINT64_TYPE__ *cases)
+{
+  if ( __tls_cmplog == nullptr ) return;
+  const size_t width = cases[1] / 8;
+  for ( __UINT64_TYPE__ i = 0; i < cases[0]; ++i )
+    if ( cases[2 + i] != val ) __cmplog_add(&cases[2 + i], width, true);
+}
+
+[[gnu::weak]] __snowball_no_coverage void
+__sanitizer_weak_hook_memcmp(void *, const void *s1, const void *s2, size_t n, int result)
+{
+  if ( result == 0 || __tls_cmplog == nullptr ) return;
+  __cmplog_add(s1, n, false);
+  __cmplog_add(s2, n, false);
+}
+
+[[gnu::weak]] __snowball_no_coverage void
+__sanitizer_weak_hook_strncmp(void *, const char *s1, const char *s2, size_t n, int result)
+{
+  if ( result != 0 ) __cmplog_str(s1, s2, n);
+}
+
+[[gnu::weak]] __snowball_no_coverage void
+__sanitizer_weak_hook_strcmp(void *, const char *s1, const char *s2, int result)
+{
+  if ( result != 0 ) __cmplog_str(s1, s2, ~size_t(0));
+}
+}
+};     // namespace __impl
+
+// string generation
+// generated text is written into a thread-local arena that is rewound, never freed, before each
+// input, so once it has grown strings cost no allocation. bytes<N>, printable<N>, utf8<N> and
+// sentence<G> are views into it and stay valid until the next input is generated on that thread.
+// string types with data()/size() (micron::string) are constructed from a mix of the three
+template <typename T> struct generator;
+
+namespace __impl
+{
+struct __text_arena {
+  static constexpr u32 max_blocks = 40;
+
+  u8 *blocks[max_blocks] = {};
+  size_t caps[max_blocks] = {};
+  u32 cur = 0;
+  size_t used = 0;      // bytes used in blocks[cur]
+  size_t start = 0;     // where the text being built begins
+
+  __text_arena() = default;
+  __text_arena(const __text_arena &) = delete;
+  __text_arena &operator=(const __text_arena &) = delete;
+  ~__text_arena()
+  {
+    for ( u8 *b : blocks ) delete[] b;
+  }
+
+  void
+  reset(void) noexcept
+  {
+    cur = 0;
+    used = start = 0;
+  }
+
+  // room for n more bytes of the text being built, which moves to a larger block if it must
+  u8 *
+  reserve(size_t n)
+  {
+    if ( blocks[cur] && caps[cur] - used >= n ) return blocks[cur] + used;
+    const size_t len = used - start;
+    u32 next = blocks[cur] ? cur + 1 : cur;
+    // every block holds at least one whole text, so only an input made of many texts gets this far
+    if ( next == max_blocks ) error("the text generated for one input spans more than 40 arena blocks");
+    while ( next < max_blocks - 1 && blocks[next] && caps[next] < len + n ) ++next;
+    if ( blocks[next] == nullptr || caps[next] < len + n ) {
+      size_t cap = 4096;
+      while ( cap < 2 * (len + n) ) cap *= 2;
+      delete[] blocks[next];
+      blocks[next] = new u8[cap];
+      caps[next] = cap;
+    }
+    if ( len ) __builtin_memcpy(blocks[next], blocks[cur] + start, len);
+    cur = next;
+    start = 0;
+    used = len;
+    return blocks[cur] + used;
+  }
+
+  void
+  put(const void *p, size_t n)
+  {
+    __builtin_memcpy(reserve(n), p, n);
+    used += n;
+  }
+
+  void
+  put(u8 c)
+  {
+    *reserve(1) = c;
+    ++used;
+  }
+
+  size_t
+  length(void) const noexcept
+  {
+    return used - start;
+  }
+
+  // terminates the text being built and begins the next one after it
+  const char *
+  finish(size_t &len)
+  {
+    len = length();
+    put(u8(0));
+    const char *p = reinterpret_cast<const char *>(blocks[cur] + start);
+    start = used;
+    return p;
+  }
+};
+
+inline thread_local __text_arena __tls_text;
+};     // namespace __impl
+
+// a generated string, nul terminated (bytes<N> may also contain nuls)
+struct text {
+  using __snowball_text = void;
+  const char *ptr = "";
+  size_t len = 0;
+
+  const char *
+  data(void) const noexcept
+  {
+    return ptr;
+  }
+
+  const char *
+  c_str(void) const noexcept
+  {
+    return ptr;
+  }
+
+  size_t
+  size(void) const noexcept
+  {
+    return len;
+  }
+
+  const char *
+  begin(void) const noexcept
+  {
+    return ptr;
+  }
+
+  const char *
+  end(void) const noexcept
+  {
+    return ptr + len;
+  }
+
+  char
+  operator[](size_t i) const noexcept
+  {
+    return ptr[i];
+  }
+};
+
+// up to N random bytes, printable ascii, or valid utf-8; lengths favour short strings
+template <size_t N = config::__default_string_max_len> struct bytes : text {
+};
+template <size_t N = config::__default_string_max_len> struct printable : text {
+};
+template <size_t N = config::__default_string_max_len> struct utf8 : text {
+};
+
+namespace __impl
+{
+enum class __text_kind : u8 { bytes, printable, utf8 };
+
+// half of all lengths are at most 16
+inline size_t
+__text_length(u64 &state, size_t max) noexcept
+{
+  const u64 r = __xorshift64(state);
+  const size_t cap = (r & 1) && max > 16 ? 16 : max;
+  return static_cast<size_t>((r >> 1) % (cap + 1));
+}
+
+inline text
+__make_text(u64 &state, size_t max, __text_kind kind)
+{
+  __text_arena &a = __tls_text;
+  const size_t n = __text_length(state, max);
+  if ( kind == __text_kind::bytes ) {
+    u8 *p = a.reserve(n);
+    for ( size_t i = 0; i < n; i += 8 ) {
+      const u64 r = __xorshift64(state);
+      __builtin_memcpy(p + i, &r, n - i < 8 ? n - i : 8);
+    }
+    a.used += n;
+  } else if ( kind == __text_kind::printable ) {
+    u8 *p = a.reserve(n);
+    for ( size_t i = 0; i < n; ++i ) p[i] = static_cast<u8>(0x20 + __xorshift64(state) % 95);
+    a.used += n;
+  } else {
+    // half ascii, then 2, 3 and 4 byte sequences; no surrogates, nothing past U+10FFFF
+    while ( a.length() < n ) {
+      const u64 r = __xorshift64(state);
+      const u32 sel = r & 7;
+      u32 cp = static_cast<u32>(r >> 32);
+      u8 seq[4];
+      size_t k;
+      if ( sel < 4 ) {
+        seq[0] = static_cast<u8>(1 + cp % 0x7f);
+        k = 1;
+      } else if ( sel < 6 ) {
+        cp = 0x80 + cp % (0x800 - 0x80);
+        seq[0] = static_cast<u8>(0xc0 | (cp >> 6));
+        seq[1] = static_cast<u8>(0x80 | (cp & 0x3f));
+        k = 2;
+      } else if ( sel == 6 ) {
+        cp = 0x800 + cp % (0x10000 - 0x800 - 0x800);
+        if ( cp >= 0xd800 ) cp += 0x800;
+        seq[0] = static_cast<u8>(0xe0 | (cp >> 12));
+        seq[1] = static_cast<u8>(0x80 | ((cp >> 6) & 0x3f));
+        seq[2] = static_cast<u8>(0x80 | (cp & 0x3f));
+        k = 3;
+      } else {
+        cp = 0x10000 + cp % (0x110000 - 0x10000);
+        seq[0] = static_cast<u8>(0xf0 | (cp >> 18));
+        seq[1] = static_cast<u8>(0x80 | ((cp >> 12) & 0x3f));
+        seq[2] = static_cast<u8>(0x80 | ((cp >> 6) & 0x3f));
+        seq[3] = static_cast<u8>(0x80 | (cp & 0x3f));
+        k = 4;
+      }
+      if ( a.length() + k > n ) break;
+      a.put(seq, k);
+    }
+  }
+  text t;
+  t.ptr = a.finish(t.len);
+  return t;
+}
+
+template <typename T>
+concept __byte_string = !micron::is_arithmetic_v<T> && !requires { typename T::__snowball_text; }
+                        && requires(const T &s, const char *p) {
+                             T(p);
+                             s.size();
+                             requires sizeof(*s.data()) == 1;
+                           };
+};     // namespace __impl
+
+template <size_t N> struct generator<bytes<N>> {
+  static bytes<N>
+  make(u64 &state)
+  {
+    return { __impl::__make_text(state, N, __impl::__text_kind::bytes) };
+  }
+};
+
+template <size_t N> struct generator<printable<N>> {
+  static printable<N>
+  make(u64 &state)
+  {
+    return { __impl::__make_text(state, N, __impl::__text_kind::printable) };
+  }
+};
+
+template <size_t N> struct generator<utf8<N>> {
+  static utf8<N>
+  make(u64 &state)
+  {
+    return { __impl::__make_text(state, N, __impl::__text_kind::utf8) };
+  }
+};
+
+// mostly printable, a quarter raw bytes, a quarter utf-8
+template <typename T>
+  requires(__impl::__byte_string<T>)
+struct generator<T> {
+  static T
+  make(u64 &state)
+  {
+    const u64 r = __impl::__xorshift64(state) & 3;
+    const __impl::__text_kind kind = r == 0   ? __impl::__text_kind::bytes
+                                     : r == 3 ? __impl::__text_kind::utf8
+                                              : __impl::__text_kind::printable;
+    const text t = __impl::__make_text(state, config::__default_string_max_len, kind);
+    if constexpr ( requires { T(t.ptr, t.len); } )
+      return T(t.ptr, t.len);
+    else
+      return T(t.ptr);
+  }
+};
+
+// grammars
+// a compact ebnf, compiled once into a node table that generation walks:
+//
+//   value  ::= object | array | number | "true" | "false" | "null"
+//   object ::= "{" (pair ("," pair)*)? "}"
+//   pair   ::= '"' [a-z]+ '"' ":" value
+//   number ::= "-"? [1-9] [0-9]*
+//
+// rules are `name ::= ...` and may span lines; the first rule is the start symbol. terms are rule
+// names, "literals" or 'literals' (with \n \t \r \\ \" \' \xHH escapes), character classes
+// [a-z_] or [^"\\], and ( ) groups, each optionally followed by ?, * or +. '#' starts a comment.
+// past the depth limit or the length budget, every choice takes its shortest way to terminate,
+// so recursive rules always end
+class grammar
+{
+  enum kind : u8 { lit, cls, ref, seq, alt, opt, star, plus };
+
+  struct node {
+    kind k;
+    u32 a;     // lit/cls: pool offset, ref: rule, seq/alt: first kid, opt/star/plus: child node
+    u32 b;     // lit/cls: byte count, seq/alt: kid count
+    u32 h;     // fewest rule expansions needed to terminate
+  };
+
+  struct rule {
+    u32 name;     // pool offset
+    u32 name_len;
+    u32 body;     // node, ~0u until defined
+    u32 line;
+  };
+
+  node *nodes = nullptr;
+  u32 *kids = nullptr;
+  rule *rules = nullptr;
+  u8 *pool = nullptr;
+  u32 node_count = 0, node_cap = 0, kid_count = 0, kid_cap = 0, rule_count = 0, rule_cap = 0, pool_len = 0, pool_cap = 0;
+  u32 max_depth;
+  size_t max_len;
+  // parser state
+  const char *src = nullptr;
+  u32 line = 1;
+
+  template <typename T>
+  static void
+  grow(T *&p, u32 &cap, u32 need)
+  {
+    if ( need <= cap ) return;
+    u32 c = cap ? cap * 2 : 64;
+    while ( c < need ) c *= 2;
+    T *q = new T[c];
+    if ( cap ) __builtin_memcpy(q, p, sizeof(T) * cap);
+    delete[] p;
+    p = q;
+    cap = c;
+  }
+
+  [[noreturn]] void
+  fail(const char *what, const char *detail = "", u32 detail_len = 0) const
+  {
+    char buf[128];
+    const u32 n = detail_len < sizeof(buf) - 1 ? detail_len : static_cast<u32>(sizeof(buf) - 1);
+    __builtin_memcpy(buf, detail, n);
+    buf[n] = 0;
+    __print_error("\033[34msnowball grammar() failure:\033[0m line ", line, ": ", what, static_cast<const char *>(buf),
+                  "\n\r");
+    __require_clbck();
+    __abort();
+  }
+
+  u32
+  add_node(kind k, u32 a, u32 b)
+  {
+    grow(nodes, node_cap, node_count + 1);
+    nodes[node_count] = { k, a, b, ~0u };
+    return node_count++;
+  }
+
+  u32
+  add_pool(const u8 *p, u32 n)
+  {
+    grow(pool, pool_cap, pool_len + n);
+    __builtin_memcpy(pool + pool_len, p, n);
+    pool_len += n;
+    return pool_len - n;
+  }
+
+  // a seq or alt node over one contiguous run of kids
+  u32
+  add_group(kind k, const u32 *items, u32 n)
+  {
+    grow(kids, kid_cap, kid_count + n);
+    __builtin_memcpy(kids + kid_count, items, sizeof(u32) * n);
+    kid_count += n;
+    return add_node(k, kid_count - n, n);
+  }
+
+  void
+  skip(void)
+  {
+    for ( ;; ) {
+      if ( *src == '\n' ) ++line;
+      if ( *src == ' ' || *src == '\t' || *src == '\r' || *src == '\n' ) {
+        ++src;
+      } else if ( *src == '#' ) {
+        while ( *src && *src != '\n' ) ++src;
+      } else {
+        return;
+      }
+    }
+  }
+
+  static bool
+  ident_char(char c) noexcept
+  {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-'
+           || c == '.';
+  }
+
+  // true at `name ::=`, the start of the next rule
+  bool
+  at_rule(void) const
+  {
+    const char *p = src;
+    if ( !ident_char(*p) ) return false;
+    while ( ident_char(*p) ) ++p;
+    while ( *p == ' ' || *p == '\t' ) ++p;
+    return p[0] == ':' && p[1] == ':' && p[2] == '=';
+  }
+
+  u32
+  find_rule(const char *name, u32 n)
+  {
+    for ( u32 i = 0; i < rule_count; ++i )
+      if ( rules[i].name_len == n && __builtin_memcmp(pool + rules[i].name, name, n) == 0 ) return i;
+    grow(rules, rule_cap, rule_count + 1);
+    rules[rule_count] = { add_pool(reinterpret_cast<const u8 *>(name), n), n, ~0u, line };
+    return rule_count++;
+  }
+
+  u8
+  escaped(void)
+  {
+    const char c = *src++;
+    if ( c != '\\' ) return static_cast<u8>(c);
+    const char e = *src++;
+    switch ( e ) {
+    case 'n':
+      return '\n';
+    case 't':
+      return '\t';
+    case 'r':
+      return '\r';
+    case 'x': {
+      u32 v = 0;
+      for ( int i = 0; i < 2; ++i ) {
+        const char d = *src++;
+        if ( d >= '0' && d <= '9' )
+          v = v * 16 + static_cast<u32>(d - '0');
+        else if ( (d | 0x20) >= 'a' && (d | 0x20) <= 'f' )
+          v = v * 16 + static_cast<u32>((d | 0x20) - 'a' + 10);
+        else
+          fail("bad \\x escape");
+      }
+      return static_cast<u8>(v);
+    }
+    case 0:
+      fail("unterminated escape");
+    default:
+      return static_cast<u8>(e);
+    }
+  }
+
+  u32
+  parse_primary(void)
+  {
+    if ( *src == '"' || *src == '\'' ) {
+      const char q = *src++;
+      u8 buf[256];
+      u32 n = 0;
+      while ( *src != q ) {
+        if ( *src == 0 || *src == '\n' ) fail("unterminated literal");
+        if ( n == sizeof(buf) ) fail("literal longer than 256 bytes");
+        buf[n++] = escaped();
+      }
+      ++src;
+      return add_node(lit, add_pool(buf, n), n);
+    }
+    if ( *src == '[' ) {
+      ++src;
+      bool set[256] = {};
+      const bool negate = *src == '^';
+      if ( negate ) ++src;
+      while ( *src != ']' ) {
+        if ( *src == 0 || *src == '\n' ) fail("unterminated character class");
+        const u8 lo = escaped();
+        u8 hi = lo;
+        if ( src[0] == '-' && src[1] != ']' ) {
+          ++src;
+          hi = escaped();
+        }
+        for ( u32 c = lo; c <= hi; ++c ) set[c] = true;
+      }
+      ++src;
+      u8 buf[256];
+      u32 n = 0;
+      for ( u32 c = 0; c < 256; ++c )
+        if ( set[c] != negate ) buf[n++] = static_cast<u8>(c);
+      if ( n == 0 ) fail("empty character class");
+      return add_node(cls, add_pool(buf, n), n);
+    }
+    if ( *src == '(' ) {
+      ++src;
+      const u32 r = parse_alt();
+      skip();
+      if ( *src != ')' ) fail("expected ')'");
+      ++src;
+      return r;
+    }
+    if ( ident_char(*src) ) {
+      const char *name = src;
+      while ( ident_char(*src) ) ++src;
+      return add_node(ref, find_rule(name, static_cast<u32>(src - name)), 0);
+    }
+    fail("unexpected ", src, 1);
+  }
+
+  u32
+  parse_seq(void)
+  {
+    u32 items[64];
+    u32 n = 0;
+    for ( ;; ) {
+      skip();
+      if ( *src == 0 || *src == '|' || *src == ')' || at_rule() ) break;
+      if ( n == 64 ) fail("more than 64 terms in a sequence");
+      u32 t = parse_primary();
+      while ( *src == '?' || *src == '*' || *src == '+' ) {
+        t = add_node(*src == '?' ? opt : *src == '*' ? star : plus, t, 0);
+        ++src;
+      }
+      items[n++] = t;
+    }
+    return n == 1 ? items[0] : add_group(seq, items, n);
+  }
+
+  u32
+  parse_alt(void)
+  {
+    u32 items[64];
+    u32 n = 0;
+    items[n++] = parse_seq();
+    while ( *src == '|' ) {
+      ++src;
+      if ( n == 64 ) fail("more than 64 alternatives");
+      items[n++] = parse_seq();
+    }
+    return n == 1 ? items[0] : add_group(alt, items, n);
+  }
+
+  u32
+  height(u32 i) const
+  {
+    const node &n = nodes[i];
+    switch ( n.k ) {
+    case lit:
+    case cls:
+    case opt:
+    case star:
+      return 0;
+    case plus:
+      return nodes[n.a].h;
+    case ref:
+      return rules[n.a].body == ~0u || nodes[rules[n.a].body].h == ~0u ? ~0u : nodes[rules[n.a].body].h + 1;
+    case seq: {
+      u32 h = 0;
+      for ( u32 k = 0; k < n.b; ++k ) h = nodes[kids[n.a + k]].h > h ? nodes[kids[n.a + k]].h : h;
+      return h;
+    }
+    case alt: {
+      u32 h = ~0u;
+      for ( u32 k = 0; k < n.b; ++k ) h = nodes[kids[n.a + k]].h < h ? nodes[kids[n.a + k]].h : h;
+      return h;
+    }
+    }
+    return ~0u;
+  }
+
+  void
+  emit(u32 i, u32 depth, u64 &state, __impl::__text_arena &out) const
+  {
+    const node &n = nodes[i];
+    const bool shortest = depth >= max_depth || out.length() >= max_len;
+    switch ( n.k ) {
+    case lit:
+      out.put(pool + n.a, n.b);
+      return;
+    case cls:
+      out.put(pool[n.a + __impl::__xorshift64(state) % n.b]);
+      return;
+    case ref:
+      emit(rules[n.a].body, depth + 1, state, out);
+      return;
+    case seq:
+      for ( u32 k = 0; k < n.b; ++k ) emit(kids[n.a + k], depth, state, out);
+      return;
+    case alt: {
+      u32 pick = kids[n.a + __impl::__xorshift64(state) % n.b];
+      if ( shortest )
+        for ( u32 k = 0; k < n.b; ++k )
+          if ( nodes[kids[n.a + k]].h < nodes[pick].h ) pick = kids[n.a + k];
+      emit(pick, depth, state, out);
+      return;
+    }
+    case opt:
+      if ( !shortest && (__impl::__xorshift64(state) & 1) ) emit(n.a, depth, state, out);
+      return;
+    case star:
+    case plus: {
+      // geometric, mean of about 2 repetitions
+      u32 reps = n.k == plus;
+      if ( !shortest )
+        for ( u64 r = __impl::__xorshift64(state); (r & 3) != 0 && reps < 16; r >>= 2 ) ++reps;
+      for ( u32 k = 0; k < reps; ++k ) emit(n.a, depth, state, out);
+      return;
+    }
+    }
+  }
+
+public:
+  explicit grammar(const char *bnf, u32 depth = config::__default_grammar_depth,
+                   size_t len = config::__default_grammar_len)
+      : max_depth(depth), max_len(len), src(bnf)
+  {
+    for ( ;; ) {
+      skip();
+      if ( *src == 0 ) break;
+      if ( !at_rule() ) fail("expected `name ::=`, got ", src, 16);
+      const char *name = src;
+      while ( ident_char(*src) ) ++src;
+      const u32 r = find_rule(name, static_cast<u32>(src - name));
+      if ( rules[r].body != ~0u ) fail("rule defined twice: ", name, static_cast<u32>(src - name));
+      rules[r].line = line;
+      skip();
+      src += 3;
+      const u32 body = parse_alt();
+      rules[r].body = body;
+      skip();
+      if ( *src == ')' ) fail("unbalanced ')'");
+    }
+    if ( rule_count == 0 ) fail("no rules");
+    for ( u32 r = 0; r < rule_count; ++r )
+      if ( rules[r].body == ~0u ) {
+        line = rules[r].line;
+        fail("undefined rule ", reinterpret_cast<const char *>(pool + rules[r].name), rules[r].name_len);
+      }
+    // fewest expansions to terminate, to a fixed point
+    for ( bool changed = true; changed; ) {
+      changed = false;
+      for ( u32 i = 0; i < node_count; ++i ) {
+        const u32 h = height(i);
+        if ( h < nodes[i].h ) {
+          nodes[i].h = h;
+          changed = true;
+        }
+      }
+    }
+    for ( u32 r = 0; r < rule_count; ++r )
+      if ( nodes[rules[r].body].h == ~0u ) {
+        line = rules[r].line;
+        fail("rule never terminates: ", reinterpret_cast<const char *>(pool + rules[r].name), rules[r].name_len);
+      }
+    src = nullptr;
+  }
+
+  ~grammar()
+  {
+    delete[] nodes;
+    delete[] kids;
+    delete[] rules;
+    delete[] pool;
+  }
+  grammar(const grammar &) = delete;
+  grammar &operator=(const grammar &) = delete;
+
+  // one sentence from the start rule, in the calling thread's arena
+  text
+  generate(u64 &state) const
+  {
+    __impl::__text_arena &out = __impl::__tls_text;
+    emit(rules[0].body, 0, state, out);
+    text t;
+    t.ptr = out.finish(t.len);
+    return t;
+  }
+};
+
+template <const grammar &G> struct sentence : text {
+};
+
+template <const grammar &G> struct generator<sentence<G>> {
+  static sentence<G>
+  make(u64 &state)
+  {
+    return { G.generate(state) };
+  }
+};
+
+namespace __impl
+{
+// draws the next fuzz() argument into var and points the crash context at its bytes
+template <typename Arg>
+void
+__fuzz_input(Arg &var, __crash_ctx &ctx)
+{
+  if constexpr ( micron::is_arithmetic_v<Arg> || __is_enum(Arg) ) {
+    u64 r = __fuzz_next() & ((1ULL << 25) - 1);
+    var = static_cast<Arg>(r);
+    // one input in four takes a comparison operand seen so far
+    if ( (r & 3) == 0 ) __cmplog_splice(reinterpret_cast<u8 *>(&var), sizeof(var), __fuzz_state);
+    ctx.input = &var;
+    ctx.input_size = sizeof(var);
+  } else {
+    __fuzz_next();
+    __tls_text.reset();
+    var = generator<Arg>::make(__fuzz_state);
+    // strings crash-report and persist their characters, not the object
+    if constexpr ( requires { var.data(); var.size(); requires sizeof(*var.data()) == 1; } ) {
+      ctx.input = var.data();
+      ctx.input_size = var.size();
+    } else {
+      ctx.input = &var;
+      ctx.input_size = sizeof(var);
+    }
+  }
+}
+};     // namespace __impl
+
+template <typename Fn>
+void
+fuzz(Fn &&fn, size_t cnt)
+{
+  using traits = function_traits<micron::remove_cvref_t<micron::decay_t<Fn>>>;
+  if constexpr ( traits::arity == 1 ) {
+    using arg = micron::remove_cvref_t<typename traits::template arg_type<0>>;
+    arg var{};
+    __impl::__crash_guard guard(&var, sizeof(var));
+    __impl::__cmplog_scope cmplog;
+    __impl::__fuzz_meter meter;
+
+    // a crashed input was already reported, resume at the one after it
+    volatile size_t next = 0;
+    static_cast<void>(sigsetjmp(guard.ctx.env, 0));
+    guard.ctx.armed = 1;
+    while ( next < cnt ) {
+      const size_t i = next;
+      next = i + 1;
+      __impl::__fuzz_input(var, guard.ctx);
+      guard.ctx.index = i;
+      fn(var);
+      meter.tick();
+    }
+    guard.finish(cnt);
+  }
+}
+
+// exception-aware fuzzing
+// fuzz_checked(fn, cnt, oracle) is fuzz() that also catches what fn throws and, given an oracle,
+// checks oracle(result) or oracle(arg, result) after every return. failures are bucketed by exception
+// type, or oracle rejection, and the innermost frames of the throw, which a __cxa_throw hook records
+// while the loop runs; where the hook isn't in effect, by exception type alone. each bucket keeps its
+// smallest input, saved as failure-<hash> next to the crash reproducers, and every bucket is reported
+// once the loop is done
+namespace __impl
+{
+struct __throw_site {
+  void *frames[16];
+  int n;
+  bool capture;
+};
+
+inline thread_local __throw_site __tls_throw{};
+
+struct __throw_capture {
+  bool prev;
+
+  __throw_capture() : prev(__tls_throw.capture) { __tls_throw.capture = true; }
+  ~__throw_capture() { __tls_throw.capture = prev; }
+  __throw_capture(const __throw_capture &) = delete;
+  __throw_capture &operator=(const __throw_capture &) = delete;
+};
+
+// interposes the c++ runtime's __cxa_throw to see the stack before it unwinds; the runtime's own
+// function is found with dlsym, so this only takes effect with libstdc++/libc++ as a shared library
+// (the default). a static runtime brings its own strong __cxa_throw, which wins over this weak one.
+// every throw in the program passes through it, define SNOWBALL_NO_THROW_HOOK to leave it out
+#if !defined(SNOWBALL_NO_THROW_HOOK)
+extern "C" {
+[[gnu::weak, noreturn]] void
+__cxa_throw(void *obj, std::type_info *type, void (*destroy)(void *))
+{
+  using throw_fn = void (*)(void *, std::type_info *, void (*)(void *));
+  static const throw_fn next = reinterpret_cast<throw_fn>(::dlsym(RTLD_NEXT, "__cxa_throw"));
+  if ( next == nullptr ) {
+    __print_error("\033[34msnowball error():\033[0m __cxa_throw hook can't find the c++ runtime's\n\r");
+    ::abort();
+  }
+#if !defined(__micron_arch_arm32)
+  __throw_site &t = __tls_throw;
+  if ( t.capture ) t.n = __walk_frames(static_cast<void **>(__builtin_frame_address(0)), t.frames, 16);
+#endif
+  next(obj, type, destroy);
+  __builtin_unreachable();
+}
+}
+#endif
+
+struct __no_oracle {
+};
+
+template <typename O, typename A, typename R>
+bool
+__oracle_accepts(O &oracle, const A &arg, const R &result)
+{
+  if constexpr ( micron::is_same_v<micron::remove_cvref_t<O>, __no_oracle> )
+    return true;
+  else if constexpr ( requires { oracle(arg, result); } )
+    return static_cast<bool>(oracle(arg, result));
+  else
+    return static_cast<bool>(oracle(result));
+}
+
+// what makes one reproducer smaller than another: length for strings, magnitude for numbers
+template <typename Arg>
+double
+__input_measure(const Arg &v, size_t bytes)
+{
+  if constexpr ( requires { v.size(); } )
+    return static_cast<double>(v.size());
+  else if constexpr ( micron::is_arithmetic_v<Arg> )
+    return v < 0 ? -static_cast<double>(v) : static_cast<double>(v);
+  else
+    return static_cast<double>(bytes);
+}
+
+template <typename Arg> struct __failure {
+  u64 key;
+  u64 hits;
+  size_t first;     // index of the first input that failed this way
+  double measure;
+  Arg input;     // views (sb::text and friends) are repointed at bytes
+  u8 *bytes;
+  size_t len;
+  char type[128];     // demangled exception type, empty for oracle rejections
+  char what[160];
+  void *frames[16];
+  int n;
+};
+
+template <typename Arg> struct __failures {
+  __failure<Arg> *list = new __failure<Arg>[config::__default_buckets];
+  u32 count = 0;
+  u64 dropped = 0;     // failures past the bucket limit
+
+  __failures() = default;
+  __failures(const __failures &) = delete;
+  __failures &operator=(const __failures &) = delete;
+  ~__failures()
+  {
+    for ( u32 i = 0; i < count; ++i ) delete[] list[i].bytes;
+    delete[] list;
+  }
+
+  static void
+  copy_str(char *dst, size_t cap, const char *src)
+  {
+    size_t i = 0;
+    for ( ; src && src[i] && i + 1 < cap; ++i ) dst[i] = src[i];
+    dst[i] = 0;
+  }
+
+  static void
+  keep(__failure<Arg> &f, const Arg &input, const __crash_ctx &ctx, double measure, const char *what)
+  {
+    copy_str(f.what, sizeof(f.what), what);
+    delete[] f.bytes;
+    f.len = ctx.input_size;
+    f.bytes = new u8[f.len + 1];
+    __builtin_memcpy(f.bytes, ctx.input, f.len);
+    f.bytes[f.len] = 0;
+    f.measure = measure;
+    f.input = input;
+    if constexpr ( requires { typename Arg::__snowball_text; } ) {
+      f.input.ptr = reinterpret_cast<const char *>(f.bytes);
+      f.input.len = f.len;
+    }
+  }
+
+  // type is the mangled exception type, nullptr for an oracle rejection
+  void
+  add(const Arg &input, const __crash_ctx &ctx, const char *type, const char *what)
+  {
+    const __throw_site &t = __tls_throw;
+    const int n = type ? t.n : 0;
+    const u64 key = __bucket_key(type ? __hash_bytes(type, __builtin_strlen(type)) : 0, t.frames, n);
+    const double measure = __input_measure(input, ctx.input_size);
+    for ( u32 i = 0; i < count; ++i )
+      if ( list[i].key == key ) {
+        ++list[i].hits;
+        if ( measure < list[i].measure ) keep(list[i], input, ctx, measure, what);
+        return;
+      }
+    if ( count == config::__default_buckets ) {
+      ++dropped;
+      return;
+    }
+    __failure<Arg> &f = list[count++];
+    f.key = key;
+    f.hits = 1;
+    f.first = ctx.index;
+    f.bytes = nullptr;
+    keep(f, input, ctx, measure, what);
+    f.type[0] = 0;
+    if ( type ) {
+      int status = -1;
+      char *name = abi::__cxa_demangle(type, nullptr, nullptr, &status);
+      copy_str(f.type, sizeof(f.type), status == 0 ? name : type);
+      ::free(name);
+    }
+    f.n = n;
+    for ( int k = 0; k < n; ++k ) f.frames[k] = t.frames[k];
+  }
+
+  void
+  report(size_t inputs) const
+  {
+    __print_error("\033[34msnowball fuzz_checked() failure:\033[0m ", count, " distinct failure(s) in ", inputs,
+                  " inputs");
+    if ( dropped ) __print_error(", ", dropped, " more past the first ", config::__default_buckets);
+    __print_error("\n\r");
+    for ( u32 i = 0; i < count; ++i ) {
+      const __failure<Arg> &f = list[i];
+      if ( f.type[0] )
+        __print_error("  [", i + 1, "] threw ", static_cast<const char *>(f.type));
+      else
+        __print_error("  [", i + 1, "] oracle rejected the result");
+      if ( f.what[0] ) __print_error(": ", static_cast<const char *>(f.what));
+      __print_error("\n\r      ", f.hits, " time(s), first on input ", f.first, ", smallest input: ");
+      __print_element(f.input);
+      char path[512];
+      __persist_crash(f.bytes, f.len, path, sizeof(path), "failure-");
+      if ( path[0] ) __print_error("\n\r      reproducer: ", static_cast<const char *>(path));
+      __print_error("\n\r");
+#if !defined(__micron_arch_arm32)
+      if ( f.type[0] && config::__default_print_stack ) __print_frames(f.frames, f.n);
+#endif
+    }
+  }
+};
+};     // namespace __impl
+
+template <typename Fn, typename Oracle = __impl::__no_oracle>
+void
+fuzz_checked(Fn &&fn, size_t cnt, Oracle &&oracle = {})
+{
+  using traits = function_traits<micron::remove_cvref_t<micron::decay_t<Fn>>>;
+  static_assert(traits::arity == 1, "snowball: fuzz_checked() takes fn(arg)");
+  using arg = micron::remove_cvref_t<typename traits::template arg_type<0>>;
+  arg var{};
+  __impl::__failures<arg> *const failures = new __impl::__failures<arg>;
+  __impl::__crash_guard guard(&var, sizeof(var));
+  __impl::__cmplog_scope cmplog;
+  __impl::__fuzz_meter meter;
+  __impl::__throw_capture capture;
+
+  // a crashed input was already reported, resume at the one after it
+  volatile size_t next = 0;
+  static_cast<void>(sigsetjmp(guard.ctx.env, 0));
+  guard.ctx.armed = 1;
+  while ( next < cnt ) {
+    const size_t i = next;
+    next = i + 1;
+    __impl::__fuzz_input(var, guard.ctx);
+    guard.ctx.index = i;
+    __impl::__tls_throw.n = 0;
+    try {
+      if constexpr ( micron::is_same_v<decltype(fn(var)), void> ) {
+        fn(var);
+      } else {
+        const auto &result = fn(var);
+        if ( !__impl::__oracle_accepts(oracle, var, result) ) failures->add(var, guard.ctx, nullptr, nullptr);
+      }
+    } catch ( const std::exception &e ) {
+      failures->add(var, guard.ctx, abi::__cxa_current_exception_type()->name(), e.what());
+    } catch ( ... ) {
+      const std::type_info *type = abi::__cxa_current_exception_type();
+      failures->add(var, guard.ctx, type ? type->name() : "(unknown)", nullptr);
+    }
+    meter.tick();
+  }
+  meter.flush();
+  const bool failed = failures->count != 0;
+  if ( failed ) failures->report(cnt);
+  delete failures;
+  guard.finish(cnt);
+  if ( failed ) {
+    __require_clbck();
+    __abort();
+  }
+}
+
+// byte buffer fuzzing
+// fuzz_bytes(fn) drives fn(const u8 *data, size_t size), the LLVMFuzzerTestOneInput signature, so
+// libFuzzer harnesses run as they are. inputs are mutated in place in one preallocated buffer, and
+// inputs that reach new edges are copied into a preallocated corpus arena to be mutated further.
+// corpus paths, given with --corpus=path or after --, work as in libFuzzer: directories seed the
+// corpus and receive its new entries, files are just run one after another
+namespace __impl
+{
+inline const char **__corpus_paths = nullptr;
+inline u32 __corpus_path_count = 0;
+
+// argc bounds the number of paths init() can collect
+inline void
+__corpus_path(const char *path, int argc)
+{
+  if ( __corpus_paths == nullptr ) __corpus_paths = new const char *[static_cast<size_t>(argc)];
+  __corpus_paths[__corpus_path_count++] = path;
+}
+
+struct __corpus {
+  struct entry {
+    size_t offset;
+    size_t len;
+  };
+
+  u8 *arena;
+  size_t arena_cap;
+  size_t arena_used = 0;
+  entry *entries;
+  u32 cap;
+  u32 count = 0;
+  const char *dir = nullptr;     // new entries are written here
+
+  __corpus(size_t bytes, u32 max_entries)
+      : arena(new u8[bytes]), arena_cap(bytes), entries(new entry[max_entries]), cap(max_entries)
+  {
+  }
+  ~__corpus()
+  {
+    delete[] arena;
+    delete[] entries;
+  }
+  __corpus(const __corpus &) = delete;
+  __corpus &operator=(const __corpus &) = delete;
+
+  bool
+  add(const u8 *data, size_t len)
+  {
+    if ( count == cap || arena_cap - arena_used < len ) return false;
+    __builtin_memcpy(arena + arena_used, data, len);
+    entries[count++] = { arena_used, len };
+    arena_used += len;
+    return true;
+  }
+
+  // copies a random entry into data, returns its length (0 while empty)
+  size_t
+  pick(u64 &state, u8 *data, size_t max_len) const
+  {
+    if ( count == 0 ) return 0;
+    const entry &e = entries[__xorshift64(state) % count];
+    const size_t len = e.len < max_len ? e.len : max_len;
+    __builtin_memcpy(data, arena + e.offset, len);
+    return len;
+  }
+};
+
+// reads up to cap bytes of path into dst
+inline size_t
+__load_file(const char *path, u8 *dst, size_t cap)
+{
+  const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if ( fd < 0 ) return 0;
+  size_t len = 0;
+  while ( len < cap ) {
+    const ssize_t r = ::read(fd, dst + len, cap - len);
+    if ( r <= 0 ) break;
+    len += static_cast<size_t>(r);
+  }
+  ::close(fd);
+  return len;
+}
+
+inline void
+__corpus_save(const char *dir, const u8 *data, size_t len)
+{
+  char path[4096];
+  size_t n = __builtin_strlen(dir);
+  if ( n + 18 > sizeof(path) ) return;
+  __builtin_memcpy(path, dir, n);
+  path[n++] = '/';
+  const u64 h = __hash_bytes(data, len);
+  for ( int i = 60; i >= 0; i -= 4 ) path[n++] = "0123456789abcdef"[(h >> i) & 15];
+  path[n] = 0;
+  const int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if ( fd < 0 ) return;
+  while ( len ) {
+    const ssize_t w = ::write(fd, data, len);
+    if ( w <= 0 ) break;
+    data += w;
+    len -= static_cast<size_t>(w);
+  }
+  ::close(fd);
+}
+
+inline void
+__corpus_load_dir(__corpus &c, const char *dir, u8 *scratch, size_t max_len)
+{
+  DIR *d = ::opendir(dir);
+  if ( d == nullptr ) return;
+  char path[4096];
+  const size_t n = __builtin_strlen(dir);
+  while ( dirent *e = ::readdir(d) ) {
+    const size_t k = __builtin_strlen(e->d_name);
+    if ( e->d_name[0] == '.' || n + k + 2 > sizeof(path) ) continue;
+    __builtin_memcpy(path, dir, n);
+    path[n] = '/';
+    __builtin_memcpy(path + n + 1, e->d_name, k + 1);
+    struct stat st;
+    if ( ::stat(path, &st) != 0 || !S_ISREG(st.st_mode) ) continue;
+    c.add(scratch, __load_file(path, scratch, max_len));
+  }
+  ::closedir(d);
+}
+
+// one to eight stacked mutations of data[0..len), returns the new length
+inline size_t
+__mutate(u8 *data, size_t len, size_t max_len, u64 &state, const __corpus &c)
+{
+  static constexpr u8 interesting[] = { 0x00, 0x01, 0x7f, 0x80, 0xff, 0x10, 0x20, 0x40 };
+  const u32 rounds = 1u << (__xorshift64(state) % 4);
+  for ( u32 round = 0; round < rounds; ++round ) {
+    const u64 r = __xorshift64(state);
+    const size_t at = len ? (r >> 8) % len : 0;
+    switch ( r % 9 ) {
+    case 0 :     // flip a bit
+      if ( len ) data[at] ^= static_cast<u8>(1u << ((r >> 4) & 7));
+      break;
+    case 1 :     // random byte
+      if ( len ) data[at] = static_cast<u8>(r >> 48);
+      break;
+    case 2 :     // interesting byte
+      if ( len ) data[at] = interesting[(r >> 4) % sizeof(interesting)];
+      break;
+    case 3 :     // small arithmetic
+      if ( len ) data[at] = static_cast<u8>(data[at] + static_cast<u8>((r >> 4) % 35) - 17);
+      break;
+    case 4 : {     // insert random bytes
+      size_t k = 1 + (r >> 4) % 8;
+      if ( len + k > max_len ) k = max_len - len;
+      __builtin_memmove(data + at + k, data + at, len - at);
+      for ( size_t i = 0; i < k; ++i ) data[at + i] = static_cast<u8>(__xorshift64(state));
+      len += k;
+      break;
+    }
+    case 5 : {     // erase a range
+      if ( len < 2 ) break;
+      const size_t k = 1 + (r >> 4) % (len - at < 16 ? len - at : 16);
+      __builtin_memmove(data + at, data + at + k, len - at - k);
+      len -= k;
+      break;
+    }
+    case 6 : {     // copy a chunk over another part of the input
+      if ( len < 2 ) break;
+      const size_t from = (r >> 32) % len;
+      size_t k = 1 + (r >> 4) % 16;
+      if ( k > len - from ) k = len - from;
+      if ( k > len - at ) k = len - at;
+      __builtin_memmove(data + at, data + from, k);
+      break;
+    }
+    case 7 :     // comparison operand
+      if ( !__cmplog_splice(data, len, state) && len < max_len ) data[len++] = static_cast<u8>(r >> 40);
+      break;
+    default : {     // crossover with another corpus entry
+      if ( c.count == 0 || len == 0 ) break;
+      const __corpus::entry &e = c.entries[(r >> 16) % c.count];
+      if ( e.len == 0 ) break;
+      const size_t from = (r >> 40) % e.len;
+      size_t k = e.len - from;
+      if ( k > len - at ) k = len - at;
+      __builtin_memcpy(data + at, c.arena + e.offset + from, k);
+      break;
+    }
+    }
+  }
+  return len;
+}
+
+// runs fn on data[0..len); with a corpus, keeps the input if it reached new edges
+template <typename Fn>
+void
+__run_bytes(Fn &fn, const u8 *data, size_t len, __corpus *corpus)
+{
+  const u64 edges = __stat(&fuzz_stats::edges);
+  // like libFuzzer, -1 keeps an input out of the corpus
+  bool keep = true;
+  if constexpr ( micron::is_integral_v<decltype(fn(data, len))> )
+    keep = static_cast<i64>(fn(data, len)) != -1;
+  else
+    fn(data, len);
+  if ( corpus && keep && __stat(&fuzz_stats::edges) != edges && corpus->add(data, len) ) {
+    __stat_add(&fuzz_stats::corpus, 1);
+    if ( corpus->dir ) __corpus_save(corpus->dir, data, len);
+  }
+}
+};     // namespace __impl
+
+template <typename Fn>
+  requires(micron::is_invocable_v<Fn &, const u8 *, size_t>)
+void
+fuzz_bytes(Fn &&fn, size_t cnt = config::__default_fuzz_runs, size_t max_len = config::__default_fuzz_max_len)
+{
+  if ( max_len == 0 ) max_len = 1;
+  __impl::__corpus *const corpus
+      = new __impl::__corpus(config::__default_corpus_bytes, config::__default_corpus_entries);
+  u8 *const data = new u8[max_len];
+  const char **const files = new const char *[__impl::__corpus_path_count + 1];
+  u32 nfiles = 0;
+  for ( u32 i = 0; i < __impl::__corpus_path_count; ++i ) {
+    struct stat st;
+    const char *path = __impl::__corpus_paths[i];
+    if ( ::stat(path, &st) != 0 ) continue;
+    if ( S_ISDIR(st.st_mode) ) {
+      __impl::__corpus_load_dir(*corpus, path, data, max_len);
+      if ( corpus->dir == nullptr ) corpus->dir = path;
+    } else {
+      files[nfiles++] = path;
+    }
+  }
+  __impl::__stat_set(&fuzz_stats::corpus, corpus->count);
+  const volatile size_t total = nfiles ? nfiles : cnt;     // volatile: read again after a siglongjmp
+
+  __impl::__crash_guard guard(data, 0);
+  __impl::__cmplog_scope cmplog;
+  __impl::__fuzz_meter meter;
+  __impl::__fuzz_next();     // seeds __fuzz_state
+
+  // a crashed input was already reported, resume at the one after it
+  volatile size_t next = 0;
+  static_cast<void>(sigsetjmp(guard.ctx.env, 0));
+  guard.ctx.armed = 1;
+  while ( next < total ) {
+    const size_t i = next;
+    next = i + 1;
+    size_t len;
+    if ( nfiles )
+      len = __impl::__load_file(files[i], data, max_len);
+    else
+      len = __impl::__mutate(data, corpus->pick(__impl::__fuzz_state, data, max_len), max_len, __impl::__fuzz_state,
+                             *corpus);
+    guard.ctx.index = i;
+    guard.ctx.input_size = len;
+    __impl::__run_bytes(fn, data, len, nfiles ? nullptr : corpus);
+    meter.tick();
+  }
+  meter.flush();
+  delete[] files;
+  delete[] data;
+  delete corpus;
+  guard.finish(total);
+  if ( nfiles ) __print("\033[34msnowball fuzz_bytes():\033[0m ran ", nfiles, " corpus file(s)\n\r");
+}
+
+// fuzz scheduling
+// fuzz_target() registers targets and fuzz_run() time-slices one process among them. slices go to
+// the target with the best discounted UCB score, where a slice scores 1 if it reached new edges or
+// crashed the target for the first time, and 0 otherwise; discounting lets a target that stopped
+// finding things fade, while the exploration term keeps retrying it now and then. without coverage
+// instrumentation only crashes count, and the budget spreads out about evenly
+namespace __impl
+{
+struct __fuzz_target {
+  const char *name;
+  void (*slice)(__fuzz_target *, __crash_ctx &, __fuzz_meter &, u64 until_ns);
+  void (*release)(__fuzz_target *);
+  __fuzz_target *next;
+  u64 execs;
+  u64 crashes;
+  u64 edges;
+  u64 ns;
+  u64 last_new_ns;     // since the start of the run, 0 if never
+  u64 slices;          // slices run
+  double pulls;        // discounted slice count, for the confidence bound
+  double reward;       // discounted productive slices
+  // taken when the current slice began
+  u64 slice_start_ns;
+  u64 slice_edges;
+  u64 slice_crashes;
+};
+
+struct __fuzz_targets {
+  __fuzz_target *head = nullptr;
+  __fuzz_target *tail = nullptr;
+  u32 count = 0;
+};
+
+inline __fuzz_targets __global_fuzz_targets;
+
+template <typename Fn, typename Arg> struct __arg_target : __fuzz_target {
+  Fn fn;
+  Arg var{};
+
+  static void
+  run(__fuzz_target *t, __crash_ctx &ctx, __fuzz_meter &meter, u64 until_ns)
+  {
+    __arg_target *self = static_cast<__arg_target *>(t);
+    do {
+      for ( u32 k = 0; k < 64; ++k ) {
+        __fuzz_input(self->var, ctx);
+        ctx.index = self->execs++;
+        self->fn(self->var);
+        meter.tick();
+      }
+    } while ( __now_ns() < until_ns );
+  }
+
+  static void
+  destroy(__fuzz_target *t)
+  {
+    delete static_cast<__arg_target *>(t);
+  }
+};
+
+template <typename Fn> struct __bytes_target : __fuzz_target {
+  Fn fn;
+  size_t max_len;
+  u8 *data;
+  __corpus corpus{ config::__default_target_corpus_bytes, config::__default_target_corpus_entries };
+
+  __bytes_target(const __fuzz_target &base, Fn &&f, size_t len)
+      : __fuzz_target(base), fn(micron::move(f)), max_len(len), data(new u8[len])
+  {
+  }
+  ~__bytes_target() { delete[] data; }
+
+  static void
+  run(__fuzz_target *t, __crash_ctx &ctx, __fuzz_meter &meter, u64 until_ns)
+  {
+    __bytes_target *self = static_cast<__bytes_target *>(t);
+    ctx.input = self->data;
+    do {
+      for ( u32 k = 0; k < 64; ++k ) {
+        const size_t picked = self->corpus.pick(__fuzz_state, self->data, self->max_len);
+        const size_t len = __mutate(self->data, picked, self->max_len, __fuzz_state, self->corpus);
+        ctx.input_size = len;
+        ctx.index = self->execs++;
+        __run_bytes(self->fn, self->data, len, &self->corpus);
+        meter.tick();
+      }
+    } while ( __now_ns() < until_ns );
+  }
+
+  static void
+  destroy(__fuzz_target *t)
+  {
+    delete static_cast<__bytes_target *>(t);
+  }
+};
+
+inline void
+__add_target(__fuzz_target *t)
+{
+  __fuzz_targets &l = __global_fuzz_targets;
+  if ( l.tail )
+    l.tail->next = t;
+  else
+    l.head = t;
+  l.tail = t;
+  ++l.count;
+}
+
+// a new target named name, run by Holder, with all of its bookkeeping zero
+template <typename Holder>
+__fuzz_target
+__target_base(const char *name)
+{
+  __fuzz_target t{};
+  t.name = name;
+  t.slice = &Holder::run;
+  t.release = &Holder::destroy;
+  return t;
+}
+
+// untried targets first, then the highest upper confidence bound
+inline __snowball_no_coverage __fuzz_target *
+__pick_target(void)
+{
+  double total = 0.0;
+  for ( __fuzz_target *t = __global_fuzz_targets.head; t; t = t->next ) {
+    if ( t->slices == 0 ) return t;
+    total += t->pulls;
+  }
+  __fuzz_target *best = nullptr;
+  double best_score = -1.0;
+  const double log_total = __builtin_log(total > 1.0 ? total : 1.0);
+  for ( __fuzz_target *t = __global_fuzz_targets.head; t; t = t->next ) {
+    const double score = t->reward / t->pulls + config::__default_sched_explore * __builtin_sqrt(log_total / t->pulls);
+    if ( score > best_score ) {
+      best = t;
+      best_score = score;
+    }
+  }
+  return best;
+}
+};     // namespace __impl
+
+// fuzz_target(name, fn) takes fuzz() targets of one argument and fuzz_bytes() targets alike
+template <typename Fn>
+void
+fuzz_target(const char *name, Fn &&fn, size_t max_len = config::__default_fuzz_max_len)
+{
+  using F = micron::decay_t<Fn>;
+  if constexpr ( micron::is_invocable_v<F &, const u8 *, size_t> ) {
+    using holder = __impl::__bytes_target<F>;
+    const __impl::__fuzz_target base = __impl::__target_base<holder>(name);
+    __impl::__add_target(new holder(base, F(micron::forward<Fn>(fn)), max_len ? max_len : 1));
+  } else {
+    using traits = function_traits<micron::remove_cvref_t<F>>;
+    static_assert(traits::arity == 1, "snowball: fuzz_target() takes fn(arg) or fn(const u8 *, size_t)");
+    using holder = __impl::__arg_target<F, micron::remove_cvref_t<typename traits::template arg_type<0>>>;
+    const __impl::__fuzz_target base = __impl::__target_base<holder>(name);
+    __impl::__add_target(new holder{ base, micron::forward<Fn>(fn) });
+  }
+}
+
+// fuzzes every registered target for a total of seconds, then reports each one's share and yield
+inline __snowball_no_coverage void
+fuzz_run(u64 seconds)
+{
+  __impl::__fuzz_targets &l = __impl::__global_fuzz_targets;
+  if ( l.head == nullptr ) return;
+  __impl::__crash_guard guard(nullptr, 0);
+  __impl::__cmplog_scope cmplog;
+  __impl::__fuzz_meter meter;
+  const u64 start = __impl::__now_ns();
+  const u64 end = start + seconds * 1000000000ULL;
+  const u64 slice_ns = config::__default_sched_slice_ms * 1000000ULL;
+  __impl::__fuzz_next();     // seeds __fuzz_state, byte targets draw from it directly
+
+  // a crash resumes the slice it interrupted
+  __impl::__fuzz_target *volatile current = nullptr;
+  volatile u64 until = 0;
+  static_cast<void>(sigsetjmp(guard.ctx.env, 0));
+  guard.ctx.armed = 1;
+  for ( ;; ) {
+    __impl::__fuzz_target *t = current;
+    if ( t == nullptr ) {
+      const u64 now = __impl::__now_ns();
+      if ( now >= end ) break;
+      t = __impl::__pick_target();
+      t->slice_start_ns = now;
+      t->slice_edges = __impl::__stat(&fuzz_stats::edges);
+      t->slice_crashes = guard.ctx.crashes;
+      __impl::__stat_target(t->name);
+      __impl::__tls_case_name = t->name;
+      until = now + slice_ns < end ? now + slice_ns : end;
+      current = t;
+    }
+    t->slice(t, guard.ctx, meter, until);
+    current = nullptr;
+
+    const u64 now = __impl::__now_ns();
+    const u64 edges = __impl::__stat(&fuzz_stats::edges) - t->slice_edges;
+    const u64 crashes = guard.ctx.crashes - t->slice_crashes;
+    // crashing again is nothing new, only a target's first crash pays
+    const bool found = edges || (crashes && t->crashes == 0);
+    t->ns += now - t->slice_start_ns;
+    t->edges += edges;
+    t->crashes += crashes;
+    if ( found ) t->last_new_ns = now - start;
+    for ( __impl::__fuzz_target *o = l.head; o; o = o->next ) {
+      o->pulls *= config::__default_sched_discount;
+      o->reward *= config::__default_sched_discount;
+    }
+    ++t->slices;
+    t->pulls += 1.0;
+    t->reward += found ? 1.0 : 0.0;
+  }
+  __impl::__tls_case_name = nullptr;
+  meter.flush();
+
+  const u64 elapsed = __impl::__now_ns() - start;
+  u64 execs = 0;
+  for ( __impl::__fuzz_target *t = l.head; t; t = t->next ) execs += t->execs;
+  __print("\033[34msnowball fuzz_run():\033[0m ", l.count, " target(s), ", execs, " execs in ");
+  __impl::__print_fixed(static_cast<double>(elapsed) / 1e9, 1);
+  __print(" s\n\r");
+  for ( __impl::__fuzz_target *t = l.head; t; ) {
+    __impl::__fuzz_target *next = t->next;
+    __print("  ", t->name, ": ");
+    __impl::__print_fixed(elapsed ? 100.0 * static_cast<double>(t->ns) / static_cast<double>(elapsed) : 0.0, 1);
+    __print("% of time, ", t->execs, " execs, ", t->edges, " new edges, ", t->crashes, " crashes");
+    if ( t->last_new_ns ) {
+      __print(", last found at ");
+      __impl::__print_fixed(static_cast<double>(t->last_new_ns) / 1e9, 1);
+      __print(" s");
+    }
+    __print("\n\r");
+    t->release(t);
+    t = next;
+  }
+  l = __impl::__fuzz_targets{};
+  guard.finish(execs);
+}
+
+// argument generation
+// specialize generator<T> with a static T make(u64 &state) to fuzz/generate other argument types
+
+template <typename T> struct generator {
+  static T
+  make(u64 &state)
+  {
+    static_assert(micron::is_arithmetic_v<T>, "snowball: specialize sb::generator<T> for this argument type");
+    if constexpr ( micron::is_same_v<T, bool> ) {
+      return __impl::__xorshift64(state) & 1;
+    } else if constexpr ( micron::is_floating_point_v<T> ) {
+      // finite values with magnitudes spread over 2^-20 .. 2^20
+      const double unit = static_cast<double>(__impl::__xorshift64(state) >> 11) * 0x1.0p-53;
+      const u64 r = __impl::__xorshift64(state);
+      const double v = __builtin_ldexp(unit, static_cast<int>(r % 41) - 20);
+      return static_cast<T>((r >> 32) & 1 ? -v : v);
+    } else {
+      return static_cast<T>(__impl::__xorshift64(state));
+    }
+  }
+};
+
+namespace __impl
+{
+template <typename Fn> using __traits = function_traits<micron::remove_cvref_t<micron::decay_t<Fn>>>;
+
+template <typename Fn, size_t... I>
+auto
+__generate_args(u64 &state, micron::index_sequence<I...>)
+{
+  using traits = __traits<Fn>;
+  return micron::tuple<micron::remove_cvref_t<typename traits::template arg_type<I>>...>{
+    generator<micron::remove_cvref_t<typename traits::template arg_type<I>>>::make(state)...
+  };
+}
+
+// every input is derived from its own index, so reports reproduce independent of thread count
+template <typename Fn>
+auto
+__generate_args(u64 seed, size_t index)
+{
+  u64 state = __mix64(seed ^ __mix64(index)) | 1;
+  __tls_text.reset();
+  return __generate_args<Fn>(state, micron::make_index_sequence<__traits<Fn>::arity>{});
+}
+
+template <typename Tuple>
+void
+__print_tuple(const Tuple &t)
+{
+  __print("(");
+  micron::apply(
+      [](const auto &...v) {
+        size_t k = 0;
+        ((__print(k++ ? ", " : ""), __print_element(v)), ...);
+      },
+      t);
+  __print(")");
+}
+
+inline int
+__thread_count(void)
+{
+#if defined(_OPENMP)
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+};     // namespace __impl
+
+// differential testing
+// generates n argument tuples for ref, runs both implementations on every one of them across all
+// cores and requires equal results (within max_ulps for floating point results)
+
+template <typename Ref, typename Fast>
+void
+differential(Ref &&ref, Fast &&fast, size_t n, u64 max_ulps = 0)
+{
+  using R = micron::remove_cvref_t<typename __impl::__traits<Ref>::return_type>;
+  const u64 seed = __impl::__fuzz_next();
+  auto same = [&](const auto &args) {
+    const R a = micron::apply(ref, args);
+    const R b = micron::apply(fast, args);
+    if constexpr ( micron::is_floating_point_v<R> )
+      return __impl::__ulp_distance(a, b) <= max_ulps;
+    else
+      return a == b;
+  };
+
+  size_t first = n, mismatches = 0;
+#pragma omp parallel for schedule(dynamic, 4096) reduction(+ : mismatches) reduction(min : first)
+  for ( size_t i = 0; i < n; ++i ) {
+    if ( !same(__impl::__generate_args<Ref>(seed, i)) ) {
+      ++mismatches;
+      if ( i < first ) first = i;
+    }
+  }
+  if ( mismatches == 0 ) return;
+
+  const auto args = __impl::__generate_args<Ref>(seed, first);
+  __print_error("\033[34msnowball differential() failure:\033[0m ", mismatches, " of ", n,
+                " inputs differ, first at input ", first, " (seed ", seed, ")\n\r  input: ");
+  __impl::__print_tuple(args);
+  __print("\n\r  ref:   ");
+  __impl::__print_element(micron::apply(ref, args));
+  __print("\n\r  fast:  ");
+  __impl::__print_element(micron::apply(fast, args));
+  __print("\n\r");
+  should_print_stack();
+  __require_clbck();
+  __abort();
+}
+
+// exhaustive testing
+// exhaustive<T>(fn, oracle) runs fn on every value of a type of up to 32 bits across all cores; for
+// floating point that is every bit pattern, nans, infinities and denormals included. oracle is either
+// a reference implementation, whose results must match (within max_ulps for floating point results,
+// and a nan only matches a nan), or a predicate oracle(arg, result). the domain is split into blocks
+// whose arguments and arithmetic results are filled in by simd loops, then compared
+
+namespace __impl
+{
+template <size_t N> struct __uint_of;
+template <> struct __uint_of<1> {
+  using type = u8;
+};
+template <> struct __uint_of<2> {
+  using type = __UINT16_TYPE__;
+};
+template <> struct __uint_of<4> {
+  using type = u32;
+};
+
+template <typename T>
+constexpr u64
+__domain_size(void) noexcept
+{
+  return micron::is_same_v<T, bool> ? 2 : 1ULL << (8 * sizeof(T));
+}
+
+template <typename T>
+[[gnu::always_inline]] inline T
+__domain_value(u64 i) noexcept
+{
+  if constexpr ( micron::is_same_v<T, bool> )
+    return i != 0;
+  else
+    return __builtin_bit_cast(T, static_cast<typename __uint_of<sizeof(T)>::type>(i));
+}
+
+template <typename R>
+[[gnu::always_inline]] inline bool
+__same_result(const R &a, const R &b, u64 max_ulps) noexcept
+{
+  if constexpr ( micron::is_floating_point_v<R> ) {
+    // without branches, so the comparison loops vectorize
+    const bool na = __is_nan(a), nb = __is_nan(b);
+    return (na & nb) | (!(na | nb) & (__ulp_bits(a, b) <= max_ulps));
+  } else {
+    return a == b;
+  }
+}
+
+inline void
+__print_bits(u64 v, size_t bytes)
+{
+  char buf[19] = "0x";
+  size_t k = 2;
+  for ( int i = static_cast<int>(bytes * 8) - 4; i >= 0; i -= 4 ) buf[k++] = "0123456789abcdef"[(v >> i) & 15];
+  buf[k] = 0;
+  __print(static_cast<const char *>(buf));
+}
+// checks one block of the domain, returning its mismatch count and recording the first few; kept
+// out of line so that the outer parallel loop isn't a nest the vectorizer gives up on
+template <typename T, typename R, bool Predicate, u64 Block, typename Fn, typename Oracle>
+[[gnu::noinline]] u64
+__exhaustive_block(Fn &fn, Oracle &oracle, u64 lo, u64 max_ulps, u64 *found, u32 &nfound)
+{
+  using U = typename __uint_of<sizeof(T) < 4 ? 4 : sizeof(T)>::type;
+  const U base = static_cast<U>(lo);
+  u64 bad = 0;
+  auto miss = [&](u64 i) {
+    ++bad;
+    if ( nfound < config::__default_table_report ) found[nfound++] = i;
+  };
+  if constexpr ( micron::is_arithmetic_v<R> ) {
+    R got[Block];
+#pragma omp simd
+    for ( U k = 0; k < Block; ++k ) got[k] = fn(__domain_value<T>(base + k));
+    if constexpr ( Predicate ) {
+      for ( U k = 0; k < Block; ++k )
+        if ( !oracle(__domain_value<T>(base + k), got[k]) ) miss(lo + k);
+    } else {
+      R want[Block];
+#pragma omp simd
+      for ( U k = 0; k < Block; ++k ) want[k] = oracle(__domain_value<T>(base + k));
+      // count first, a block only gets walked again to find its mismatches if it has some
+      u32 differ = 0;
+#pragma omp simd reduction(+ : differ)
+      for ( U k = 0; k < Block; ++k ) differ += !__same_result(got[k], want[k], max_ulps);
+      if ( differ )
+        for ( U k = 0; k < Block; ++k )
+          if ( !__same_result(got[k], want[k], max_ulps) ) miss(lo + k);
+    }
+  } else {
+    for ( U k = 0; k < Block; ++k ) {
+      const T v = __domain_value<T>(base + k);
+      bool ok;
+      if constexpr ( Predicate )
+        ok = oracle(v, fn(v));
+      else
+        ok = __same_result(R(fn(v)), R(oracle(v)), max_ulps);
+      if ( !ok ) miss(lo + k);
+    }
+  }
+  return bad;
+}
+};     // namespace __impl
+
+template <typename T, typename Fn, typename Oracle>
+void
+exhaustive(Fn &&fn, Oracle &&oracle, u64 max_ulps = 0)
+{
+  static_assert((micron::is_arithmetic_v<T> || __is_enum(T)) && sizeof(T) <= 4,
+                "snowball: exhaustive() covers types of up to 32 bits");
+  using R = micron::remove_cvref_t<decltype(fn(T{}))>;
+  constexpr bool predicate = requires(const R &r) { oracle(T{}, r); };
+  constexpr u64 domain = __impl::__domain_size<T>();
+  // domains are powers of two, so every block is full and the simd loops have constant trip counts
+  constexpr u64 block = domain < 2048 ? domain : 2048;
+  constexpr u64 blocks = domain / block;
+
+  u64 mismatches = 0;
+  __impl::__first_misses first;
+#pragma omp parallel for schedule(dynamic, 16) reduction(+ : mismatches)
+  for ( u64 b = 0; b < blocks; ++b ) {
+    u64 found[config::__default_table_report];
+    u32 nfound = 0;
+    const u64 bad = __impl::__exhaustive_block<T, R, predicate, block>(fn, oracle, b * block, max_ulps, found, nfound);
+    if ( bad ) {
+      mismatches += bad;
+#pragma omp critical(snowball_exhaustive)
+      first.merge(found, nfound);
+    }
+  }
+  if ( mismatches == 0 ) return;
+
+  __print_error("\033[34msnowball exhaustive() failure:\033[0m ", mismatches, " of ", domain, " inputs mismatched");
+  __print(mismatches > first.count ? ", the first ones:\n\r" : ":\n\r");
+  for ( u32 k = 0; k < first.count; ++k ) {
+    const T v = __impl::__domain_value<T>(first.index[k]);
+    __print("  input ");
+    __impl::__print_bits(first.index[k], sizeof(T));
+    __print(" (");
+    __impl::__print_element(v);
+    __print("): got ");
+    __impl::__print_element(fn(v));
+    if constexpr ( !predicate ) {
+      __print(", expected ");
+      __impl::__print_element(oracle(v));
+    }
+    __print("\n\r");
+  }
+  should_print_stack();
+  __require_clbck();
+  __abort();
+}
+
+// combinatorial testing
+// require_product(fn, oracle, sets...) runs fn on every combination of one element from each set;
+// require_covering<t>(...) only on a covering array, a set of combinations in which every t-tuple of
+// values from any t of the sets appears at least once. most failures are triggered by the interaction
+// of a few parameters, so t = 2 or 3 catches them in a small fraction of the product. oracle is a
+// reference implementation or a predicate oracle(args..., result), as for exhaustive()
+
+namespace __impl
+{
+// greedy t-wise covering array over k columns with the given numbers of values, returned as rows of k
+// value indices. each row starts from the first value tuple still uncovered, then fills the remaining
+// columns in order, each with the value that completes the most uncovered tuples
+inline u32 *
+__covering_rows(const u32 *sizes, u32 k, u32 t, u64 &rows)
+{
+  u64 nsub = 1;
+  for ( u32 i = 0; i < t; ++i ) nsub = nsub * (k - i) / (i + 1);
+  // the column subsets of size t in lexicographic order, where their value tuples start, and the
+  // subsets each column belongs to
+  u32 *subs = new u32[nsub * t];
+  u64 *base = new u64[nsub + 1];
+  u32 *by_col = new u32[nsub * t];
+  u32 *col_start = new u32[k + 1]{};
+  u32 c[64];
+  for ( u32 i = 0; i < t; ++i ) c[i] = i;
+  base[0] = 0;
+  for ( u64 s = 0; s < nsub; ++s ) {
+    u64 tuples = 1;
+    for ( u32 j = 0; j < t; ++j ) {
+      subs[s * t + j] = c[j];
+      tuples *= sizes[c[j]];
+      ++col_start[c[j] + 1];
+    }
+    base[s + 1] = base[s] + tuples;
+    u32 i = t;
+    while ( i && c[i - 1] == k - t + i - 1 ) --i;
+    if ( i == 0 ) break;
+    ++c[i - 1];
+    for ( u32 j = i; j < t; ++j ) c[j] = c[j - 1] + 1;
+  }
+  for ( u32 i = 0; i < k; ++i ) col_start[i + 1] += col_start[i];
+  {
+    u32 *fill = new u32[k];
+    for ( u32 i = 0; i < k; ++i ) fill[i] = col_start[i];
+    for ( u64 s = 0; s < nsub; ++s )
+      for ( u32 j = 0; j < t; ++j ) by_col[fill[subs[s * t + j]]++] = static_cast<u32>(s);
+    delete[] fill;
+  }
+
+  constexpr u32 unset = ~0u;
+  u8 *covered = new u8[base[nsub]]{};
+  u32 *row = new u32[k];
+  // index of the row's value tuple in subset s, or ~0 if one of its columns isn't set yet
+  auto tuple = [&](u64 s) -> u64 {
+    u64 x = 0;
+    for ( u32 j = 0; j < t; ++j ) {
+      const u32 col = subs[s * t + j];
+      if ( row[col] == unset ) return ~0ULL;
+      x = x * sizes[col] + row[col];
+    }
+    return base[s] + x;
+  };
+
+  u64 cap = 64, left = base[nsub], cursor = 0, sub = 0;
+  u32 *out = new u32[cap * k];
+  rows = 0;
+  while ( left ) {
+    while ( covered[cursor] ) ++cursor;
+    while ( base[sub + 1] <= cursor ) ++sub;
+    for ( u32 i = 0; i < k; ++i ) row[i] = unset;
+    u64 x = cursor - base[sub];
+    for ( u32 j = t; j-- > 0; ) {
+      const u32 col = subs[sub * t + j];
+      row[col] = static_cast<u32>(x % sizes[col]);
+      x /= sizes[col];
+    }
+    for ( u32 i = 0; i < k; ++i ) {
+      if ( row[i] != unset ) continue;
+      u32 best = 0;
+      u64 best_gain = 0;
+      for ( u32 v = 0; v < sizes[i]; ++v ) {
+        row[i] = v;
+        u64 gain = 0;
+        for ( u32 p = col_start[i]; p < col_start[i + 1]; ++p ) {
+          const u64 at = tuple(by_col[p]);
+          gain += at != ~0ULL && !covered[at];
+        }
+        if ( gain > best_gain ) {
+          best = v;
+          best_gain = gain;
+        }
+      }
+      row[i] = best;
+    }
+    for ( u64 s = 0; s < nsub; ++s ) {
+      const u64 at = tuple(s);
+      left -= !covered[at];
+      covered[at] = 1;
+    }
+    if ( rows == cap ) {
+      u32 *grown = new u32[2 * cap * k];
+      __builtin_memcpy(grown, out, cap * k * sizeof(u32));
+      delete[] out;
+      out = grown;
+      cap *= 2;
+    }
+    __builtin_memcpy(out + rows++ * k, row, k * sizeof(u32));
+  }
+  delete[] row;
+  delete[] covered;
+  delete[] col_start;
+  delete[] by_col;
+  delete[] base;
+  delete[] subs;
+  return out;
+}
+
+// runs fn on each combination, the rows of a covering array or the full product if rows is null, and
+// reports the first failing ones; returns whether all of them passed
+template <typename Fn, typename Oracle, typename... Sets>
+bool
+__product(const char *who, Fn &fn, Oracle &oracle, const u32 *rows, u64 count, const Sets &...sets)
+{
+  constexpr u32 k = sizeof...(Sets);
+  static_assert(k > 0, "snowball: combinatorial tests need at least one set");
+  const u32 sizes[k] = { static_cast<u32>(__range_size(sets))... };
+  using R = micron::remove_cvref_t<decltype(fn(*__range_data(sets)...))>;
+  constexpr bool predicate = requires(const R &r) { oracle(*__range_data(sets)..., r); };
+  constexpr auto seq = micron::make_index_sequence<k>{};
+  auto indices = [&](u64 r, u32 *idx) {
+    if ( rows ) {
+      for ( u32 c = 0; c < k; ++c ) idx[c] = rows[r * k + c];
+    } else {
+      // mixed radix, the last set varies fastest
+      for ( u32 c = k; c-- > 0; ) {
+        idx[c] = static_cast<u32>(r % sizes[c]);
+        r /= sizes[c];
+      }
+    }
+  };
+  auto passes = [&]<size_t... I>(const u32 *idx, micron::index_sequence<I...>) -> bool {
+    if constexpr ( predicate )
+      return oracle(__range_data(sets)[idx[I]]..., fn(__range_data(sets)[idx[I]]...));
+    else
+      return __same_result(R(fn(__range_data(sets)[idx[I]]...)), R(oracle(__range_data(sets)[idx[I]]...)), 0);
+  };
+
+  constexpr u64 block = 256;
+  const u64 blocks = (count + block - 1) / block;
+  u64 failures = 0;
+  __first_misses first;
+#pragma omp parallel for schedule(dynamic, 1) reduction(+ : failures)
+  for ( u64 b = 0; b < blocks; ++b ) {
+    const u64 lo = b * block;
+    const u64 hi = count - lo < block ? count : lo + block;
+    u64 found[config::__default_table_report];
+    u32 nfound = 0, idx[k];
+    u64 bad = 0;
+    for ( u64 r = lo; r < hi; ++r ) {
+      indices(r, idx);
+      if ( passes(idx, seq) ) continue;
+      ++bad;
+      if ( nfound < config::__default_table_report ) found[nfound++] = r;
+    }
+    if ( bad ) {
+      failures += bad;
+#pragma omp critical(snowball_product)
+      first.merge(found, nfound);
+    }
+  }
+  if ( failures == 0 ) return true;
+
+  __print_error("\033[34msnowball ", who, " failure:\033[0m ", failures, " of ", count, " combinations failed");
+  __print(failures > first.count ? ", the first ones:\n\r" : ":\n\r");
+  for ( u32 f = 0; f < first.count; ++f ) {
+    u32 idx[k];
+    indices(first.index[f], idx);
+    [&]<size_t... I>(micron::index_sequence<I...>) {
+      __print("  (");
+      size_t n = 0;
+      ((__print(n++ ? ", " : ""), __print_element(__range_data(sets)[idx[I]])), ...);
+      __print("): got ");
+      __print_element(fn(__range_data(sets)[idx[I]]...));
+      if constexpr ( !predicate ) {
+        __print(", expected ");
+        __print_element(oracle(__range_data(sets)[idx[I]]...));
+      }
+      __print("\n\r");
+    }(seq);
+  }
+  return false;
+}
+
+template <typename... Sets>
+u64
+__product_size(const Sets &...sets)
+{
+  return (static_cast<u64>(__range_size(sets)) * ...);
+}
+
+// covering array for the given sets, or null when it would be the full product anyway
+template <u32 Strength, typename... Sets>
+u32 *
+__covering(u64 &count, const Sets &...sets)
+{
+  static_assert(Strength > 0 && Strength <= 64, "snowball: covering strength must be between 1 and 64");
+  count = __product_size(sets...);
+  if ( Strength >= sizeof...(Sets) || count == 0 ) return nullptr;
+  const u32 sizes[] = { static_cast<u32>(__range_size(sets))... };
+  return __covering_rows(sizes, sizeof...(Sets), Strength, count);
+}
+};     // namespace __impl
+
+// every combination of one element from each set
+template <typename Fn, typename Oracle, typename... Sets>
+void
+require_product(Fn &&fn, Oracle &&oracle, const Sets &...sets)
+{
+  if ( !__impl::__product("require_product()", fn, oracle, nullptr, __impl::__product_size(sets...), sets...) ) {
+    should_print_stack();
+    __require_clbck();
+    __abort();
+  }
+}
+
+template <typename Fn, typename Oracle, typename... Sets>
+void
+check_product(Fn &&fn, Oracle &&oracle, const Sets &...sets)
+{
+  if ( !__impl::__product("check_product()", fn, oracle, nullptr, __impl::__product_size(sets...), sets...) ) {
+    should_print_stack();
+    __check_clbck();
+  }
+}
+
+// every Strength-tuple of values from any Strength of the sets, in far fewer combinations
+template <u32 Strength = 2, typename Fn, typename Oracle, typename... Sets>
+void
+require_covering(Fn &&fn, Oracle &&oracle, const Sets &...sets)
+{
+  u64 count;
+  u32 *rows = __impl::__covering<Strength>(count, sets...);
+  const bool ok = __impl::__product("require_covering()", fn, oracle, rows, count, sets...);
+  delete[] rows;
+  if ( !ok ) {
+    should_print_stack();
+    __require_clbck();
+    __abort();
+  }
+}
+
+template <u32 Strength = 2, typename Fn, typename Oracle, typename... Sets>
+void
+check_covering(Fn &&fn, Oracle &&oracle, const Sets &...sets)
+{
+  u64 count;
+  u32 *rows = __impl::__covering<Strength>(count, sets...);
+  const bool ok = __impl::__product("check_covering()", fn, oracle, rows, count, sets...);
+  delete[] rows;
+  if ( !ok ) {
+    should_print_stack();
+    __check_clbck();
+  }
+}
+
+// stateful fuzzing
+// runs random sequences of member function calls on copies of object and model side by side. each
+// op pairs a member function of the object with its counterpart on the model, called with the same
+// generated arguments; non-void results must compare equal, and if model == object compiles the
+// states are compared after every step. a failing sequence is shrunk by dropping steps and zeroing
+// arguments while it keeps failing. object and model have to be copyable, every sequence starts
+// from fresh copies
+
+namespace __impl
+{
+template <typename F, typename G> struct __op_pair {
+  const char *name;
+  F object_fn;
+  G model_fn;
+};
+
+struct __step {
+  u32 op;
+  u64 seed;     // 0 for value initialized arguments
+};
+};     // namespace __impl
+
+template <typename F, typename G>
+  requires(micron::is_member_function_pointer_v<F> && micron::is_member_function_pointer_v<G>)
+__impl::__op_pair<F, G>
+op(const char *name, F object_fn, G model_fn)
+{
+  return { name, object_fn, model_fn };
+}
+
+template <typename F, typename G>
+  requires(micron::is_member_function_pointer_v<F> && micron::is_member_function_pointer_v<G>)
+__impl::__op_pair<F, G>
+op(F object_fn, G model_fn)
+{
+  return { nullptr, object_fn, model_fn };
+}
+
+namespace __impl
+{
+template <typename F>
+auto
+__step_args(u64 seed)
+{
+  using args = decltype(__generate_args<F>(seed, 0));
+  return seed ? __generate_args<F>(seed, 0) : args{};
+}
+
+// 0 if object and model agree after the step, 1 if the results differ, 2 if the states do; with
+// report set the step is printed along with what went wrong
+template <typename Object, typename Model, typename F, typename G>
+int
+__run_op(Object &o, Model &m, const __op_pair<F, G> &p, u32 index, u64 seed, bool report)
+{
+  auto args = __step_args<F>(seed);
+  auto model_args = args;
+  if ( report ) {
+    if ( p.name )
+      __print(p.name);
+    else
+      __print("op", index);
+    __print_tuple(args);
+  }
+  int why = 0;
+  using R = typename __traits<F>::return_type;
+  if constexpr ( micron::is_void_v<R> ) {
+    micron::apply([&](auto &...v) { (o.*p.object_fn)(v...); }, args);
+    micron::apply([&](auto &...v) { (m.*p.model_fn)(v...); }, model_args);
+  } else {
+    const auto a = micron::apply([&](auto &...v) { return (o.*p.object_fn)(v...); }, args);
+    const auto b = micron::apply([&](auto &...v) { return (m.*p.model_fn)(v...); }, model_args);
+    if ( !(a == b) ) why = 1;
+    if ( report ) {
+      __print(" -> ");
+      __print_element(a);
+      if ( why ) {
+        __print(", model returned ");
+        __print_element(b);
+      }
+    }
+  }
+  if constexpr ( requires { m == o; } )
+    if ( !why && !(m == o) ) why = 2;
+  if ( report && why == 2 ) __print(", state differs from the model");
+  return why;
+}
+
+// replays steps on fresh copies, returns the index of the first failing step or n
+template <typename Object, typename Model, typename Ops>
+u32
+__replay(const Object &object, const Model &model, const Ops &ops, const __step *steps, u32 n, bool report = false)
+{
+  Object o = object;
+  Model m = model;
+  for ( u32 k = 0; k < n; ++k ) {
+    int why = 0;
+    u32 j = 0;
+    const __step s = steps[k];
+    if ( report ) __print("  ", k + 1, ". ");
+    micron::apply(
+        [&](const auto &...p) {
+          ((j == s.op ? static_cast<void>(why = __run_op(o, m, p, j, s.seed, report)) : static_cast<void>(0), ++j), ...);
+        },
+        ops);
+    if ( report ) __print("\n\r");
+    if ( why ) return k;
+  }
+  return n;
+}
+
+// steps[0..n) fail at their last step; returns the length of the shrunk sequence
+template <typename Object, typename Model, typename Ops>
+u32
+__shrink_steps(const Object &object, const Model &model, const Ops &ops, __step *steps, u32 n)
+{
+  __step *candidate = new __step[n];
+  size_t budget = config::__default_shrink_budget;
+  for ( u32 chunk = n / 2; chunk >= 1 && budget; ) {
+    bool removed = false;
+    for ( u32 start = 0; start < n && budget; ) {
+      u32 m = 0;
+      for ( u32 i = 0; i < n; ++i )
+        if ( i < start || i >= start + chunk ) candidate[m++] = steps[i];
+      --budget;
+      const u32 k = m ? __replay(object, model, ops, candidate, m) : m;
+      if ( k < m ) {
+        n = k + 1;
+        __builtin_memcpy(steps, candidate, n * sizeof(__step));
+        removed = true;
+      } else {
+        start += chunk;
+      }
+    }
+    if ( !removed ) chunk /= 2;
+  }
+  for ( u32 i = 0; i < n && budget; ++i, --budget ) {
+    if ( steps[i].seed == 0 ) continue;
+    const u64 seed = steps[i].seed;
+    steps[i].seed = 0;
+    const u32 k = __replay(object, model, ops, steps, n);
+    if ( k < n )
+      n = k + 1;
+    else
+      steps[i].seed = seed;
+  }
+  delete[] candidate;
+  return n;
+}
+};     // namespace __impl
+
+template <typename Object, typename Model, typename... F, typename... G>
+void
+fuzz_stateful(const Object &object, const Model &model, __impl::__op_pair<F, G>... ops)
+{
+  static_assert(sizeof...(F) > 0, "snowball: fuzz_stateful() needs at least one op");
+  const auto table = micron::make_tuple(ops...);
+  constexpr u32 length = config::__default_stateful_steps;
+  __impl::__step steps[length];
+  for ( size_t run = 0; run < config::__default_stateful_runs; ++run ) {
+    const u64 seed = __impl::__fuzz_next();
+    u64 state = seed | 1;
+    for ( u32 k = 0; k < length; ++k )
+      steps[k] = { static_cast<u32>(__impl::__xorshift64(state) % sizeof...(F)), __impl::__xorshift64(state) | 1 };
+    const u32 failed = __impl::__replay(object, model, table, steps, length);
+    if ( failed == length ) continue;
+
+    const u32 n = __impl::__shrink_steps(object, model, table, steps, failed + 1);
+    __print_error("\033[34msnowball fuzz_stateful() failure:\033[0m sequence ", run, " (seed ", seed,
+                  ") failed at step ", failed + 1, ", shrunk to ", n, " step(s):\n\r");
+    __impl::__replay(object, model, table, steps, n, true);
+    should_print_stack();
+    __require_clbck();
+    __abort();
+  }
+}
+
+// concurrency stress
+// spawns pinned threads that are released together from a spin barrier and hammer fn; fn is called
+// as fn(thread, iteration), fn(thread) or fn(), and returning false counts as a failure just like a
+// failed check() inside it does
+
+namespace __impl
+{
+[[gnu::always_inline]] inline void
+__cpu_relax() noexcept
+{
+#if defined(__micron_arch_amd64)
+  __builtin_ia32_pause();
+#elif defined(__micron_arch_arm64) || defined(__micron_arch_arm32)
+  asm volatile("yield" ::: "memory");
+#else
+  asm volatile("" ::: "memory");
+#endif
+}
+
+struct alignas(64) __stress_slot {
+  u64 ns;
+  u64 failures;
+};
+
+struct __stress_shared {
+  u32 threads;
+  u64 iterations;
+  bool jitter;
+  u32 ready;
+  u32 go;
+  u64 start_ns;
+  void *fn;
+  __stress_slot *slots;
+};
+
+template <typename Fn>
+[[gnu::always_inline]] inline bool
+__stress_call(Fn &fn, u32 t, u64 i)
+{
+  if constexpr ( micron::is_invocable_v<Fn &, u32, u64> ) {
+    if constexpr ( micron::is_same_v<decltype(fn(t, i)), bool> )
+      return fn(t, i);
+    else
+      return fn(t, i), true;
+  } else if constexpr ( micron::is_invocable_v<Fn &, u32> ) {
+    if constexpr ( micron::is_same_v<decltype(fn(t)), bool> )
+      return fn(t);
+    else
+      return fn(t), true;
+  } else {
+    if constexpr ( micron::is_same_v<decltype(fn()), bool> )
+      return fn();
+    else
+      return fn(), true;
+  }
+}
+
+template <typename Fn> struct __stress_thread {
+  __stress_shared *shared;
+  u32 index;
+
+  static void *
+  run(void *arg)
+  {
+    __stress_thread *self = static_cast<__stress_thread *>(arg);
+    __stress_shared &s = *self->shared;
+    Fn &fn = *static_cast<Fn *>(s.fn);
+    const u32 t = self->index;
+    u64 state = __mix64(t + 1) | 1;
+    u64 failures = 0;
+
+    __atomic_fetch_add(&s.ready, 1, __ATOMIC_ACQ_REL);
+    while ( !__atomic_load_n(&s.go, __ATOMIC_ACQUIRE) ) __cpu_relax();
+
+    for ( u64 i = 0; i < s.iterations; ++i ) {
+      if ( s.jitter ) {
+        // perturb the interleaving: mostly nothing, sometimes a short spin, rarely a yield
+        const u64 r = __xorshift64(state);
+        if ( (r & 15) == 0 )
+          for ( u64 k = (r >> 8) & 63; k; --k ) __cpu_relax();
+        else if ( (r & 1023) == 1 )
+          ::sched_yield();
+      }
+      failures += !__stress_call(fn, t, i);
+    }
+    s.slots[t].ns = __now_ns() - s.start_ns;
+    s.slots[t].failures = failures;
+    return nullptr;
+  }
+};
+
+// the n-th cpu of the inherited affinity mask, so pinning respects taskset/cgroups
+inline int
+__nth_cpu(const cpu_set_t &mask, u32 n)
+{
+  const int count = CPU_COUNT(&mask);
+  if ( count <= 0 ) return -1;
+  int want = static_cast<int>(n % static_cast<u32>(count));
+  for ( int c = 0; c < CPU_SETSIZE; ++c )
+    if ( CPU_ISSET(c, &mask) && want-- == 0 ) return c;
+  return -1;
+}
+};     // namespace __impl
+
+template <typename Fn>
+void
+stress(u32 threads, u64 iterations, Fn &&fn, bool jitter = false)
+{
+  if ( threads == 0 ) threads = 1;
+  __impl::__stress_slot *slots = new __impl::__stress_slot[threads]{};
+  using thread_ctx = __impl::__stress_thread<micron::remove_reference_t<Fn>>;
+  thread_ctx *ctx = new thread_ctx[threads];
+  pthread_t *tids = new pthread_t[threads];
+  __impl::__stress_shared shared{ threads, iterations, jitter, 0, 0, 0, &fn, slots };
+  const u64 failures_before = __atomic_load_n(&__global_failures, __ATOMIC_RELAXED);
+
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  const bool pin = ::sched_getaffinity(0, sizeof(mask), &mask) == 0;
+  for ( u32 t = 0; t < threads; ++t ) {
+    ctx[t] = { &shared, t };
+    pthread_attr_t attr;
+    ::pthread_attr_init(&attr);
+    const int cpu = pin ? __impl::__nth_cpu(mask, t) : -1;
+    if ( cpu >= 0 ) {
+      cpu_set_t one;
+      CPU_ZERO(&one);
+      CPU_SET(cpu, &one);
+      ::pthread_attr_setaffinity_np(&attr, sizeof(one), &one);
+    }
+    if ( ::pthread_create(&tids[t], &attr, &__impl::__stress_thread<micron::remove_reference_t<Fn>>::run, &ctx[t]) != 0 )
+      error("stress(): couldn't spawn thread");
+    ::pthread_attr_destroy(&attr);
+  }
+  while ( __atomic_load_n(&shared.ready, __ATOMIC_ACQUIRE) != threads ) __impl::__cpu_relax();
+  shared.start_ns = __impl::__now_ns();
+  __atomic_store_n(&shared.go, 1, __ATOMIC_RELEASE);
+  for ( u32 t = 0; t < threads; ++t ) ::pthread_join(tids[t], nullptr);
+
+  u64 wall = 1, failures = 0;
+  double sum = 0.0, sum_sq = 0.0, fastest = 0.0, slowest = 0.0;
+  for ( u32 t = 0; t < threads; ++t ) {
+    const u64 ns = slots[t].ns ? slots[t].ns : 1;
+    const double rate = static_cast<double>(iterations) / static_cast<double>(ns);
+    wall = ns > wall ? ns : wall;
+    failures += slots[t].failures;
+    sum += rate;
+    sum_sq += rate * rate;
+    fastest = t == 0 || rate > fastest ? rate : fastest;
+    slowest = t == 0 || rate < slowest ? rate : slowest;
+  }
+  failures += __atomic_load_n(&__global_failures, __ATOMIC_RELAXED) - failures_before;
+
+  // jain's index: 1 is perfectly fair, 1/threads is one thread doing all the work
+  __print("\033[34msnowball stress:\033[0m ", threads, " threads x ", iterations, " iterations, ");
+  __impl::__print_fixed(static_cast<double>(iterations) * threads / static_cast<double>(wall) * 1e3, 3);
+  __print(" Mops/s, fairness ");
+  __impl::__print_fixed(sum_sq > 0.0 ? sum * sum / (threads * sum_sq) : 1.0, 3);
+  __print(" (slowest thread at ");
+  __impl::__print_fixed(fastest > 0.0 ? slowest / fastest * 100.0 : 100.0, 1);
+  __print("% of the fastest)\n\r");
+
+  delete[] tids;
+  delete[] ctx;
+  if ( failures ) {
+    __print_error("\033[34msnowball stress() failure:\033[0m ", failures, " failure(s); per thread:");
+    for ( u32 t = 0; t < threads; ++t ) __print(" ", slots[t].failures);
+    __print("\n\r");
+    delete[] slots;
+    should_print_stack();
+    __require_clbck();
+    __abort();
+  }
+  delete[] slots;
+}
+
+// linearizability
+// history<Op> records timestamped invoke/response pairs per thread, without locks. a recorded history
+// is checked against a sequential model with the wing & gong search, memoized on (linearized set,
+// model state) as in lowe's variant, and optionally split into independent partitions first
+// (p-compositionality, e.g. one partition per key of a map). a failing history is cut down to the
+// first response that the ops called before it can't explain, and the ops leading up to it reported
+//
+// the model is default constructible and copyable, and provides bool step(const Op &) which applies
+// the op and returns whether the op's recorded output matches the model's. models with an operator==,
+// or with bytewise comparable state, get memoized, a u64 hash() const spreads them better; others are
+// searched exhaustively
+
+namespace __impl
+{
+// a timestamp that no surrounding memory operation can be reordered across
+[[gnu::always_inline]] inline u64
+__ordered_cycles() noexcept
+{
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#if defined(__micron_arch_amd64)
+  asm volatile("lfence" ::: "memory");
+  const u64 t = __cycle_counter();
+  asm volatile("lfence" ::: "memory");
+#elif defined(__micron_arch_arm64)
+  asm volatile("isb" ::: "memory");
+  const u64 t = __cycle_counter();
+  asm volatile("isb" ::: "memory");
+#elif defined(__micron_arch_arm32)
+  const u64 t = __cycle_counter();
+#else
+  const u64 t = __now_ns();
+#endif
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  return t;
+}
+
+template <typename Op> struct __lin_entry {
+  Op op;
+  u64 call;
+  u64 ret;
+  u32 thread;
+};
+
+struct __lin_event {
+  u32 id;
+  bool call;
+  __lin_event *prev;
+  __lin_event *next;
+  __lin_event *match;
+};
+
+template <typename Model>
+constexpr bool __model_memoizable = requires(const Model &m) {
+  { m == m };
+} || __bytewise_comparable<Model>;
+
+template <typename Model>
+u64
+__model_hash(const Model &m)
+{
+  if constexpr ( requires { m.hash(); } )
+    return static_cast<u64>(m.hash());
+  else if constexpr ( __bytewise_comparable<Model> )
+    return __hash_bytes(&m, sizeof(Model));
+  else
+    return 0;
+}
+
+template <typename Model>
+bool
+__model_equal(const Model &a, const Model &b)
+{
+  if constexpr ( requires { a == b; } )
+    return static_cast<bool>(a == b);
+  else
+    return __builtin_memcmp(&a, &b, sizeof(Model)) == 0;
+}
+
+// (linearized set, model state) pairs already searched from. both are kept and compared exactly, the
+// set as a bitset over the ops, so a hash collision or a weak hash() can only cost time, never prune
+// a branch that wasn't searched
+template <typename Model> struct __lin_memo {
+  u32 words;
+  u64 *sets = nullptr;        // words per entry
+  Model *states = nullptr;
+  u64 *hashes = nullptr;
+  u32 *slots = nullptr;       // entry index + 1, 0 marks empty slots
+  size_t cap = 0;
+  size_t size = 0;
+  size_t entries_cap = 0;
+
+  explicit __lin_memo(u32 n) : words((n + 63) / 64) {}
+  ~__lin_memo()
+  {
+    delete[] sets;
+    delete[] states;
+    delete[] hashes;
+    delete[] slots;
+  }
+  __lin_memo(const __lin_memo &) = delete;
+  __lin_memo &operator=(const __lin_memo &) = delete;
+
+  // returns false if the pair was already present
+  bool
+  insert(const u64 *set, u64 set_hash, const Model &m)
+  {
+    const u64 h = __mix64(set_hash ^ __mix64(__model_hash(m)));
+    if ( 2 * (size + 1) > cap ) grow();
+    size_t i = h & (cap - 1);
+    for ( ; slots[i]; i = (i + 1) & (cap - 1) ) {
+      const size_t k = slots[i] - 1;
+      if ( hashes[k] == h && __builtin_memcmp(sets + k * words, set, words * sizeof(u64)) == 0
+           && __model_equal(states[k], m) )
+        return false;
+    }
+    if ( size == entries_cap ) {
+      entries_cap = entries_cap ? entries_cap * 2 : 256;
+      u64 *ns = new u64[entries_cap * words];
+      Model *nm = new Model[entries_cap];
+      u64 *nh = new u64[entries_cap];
+      for ( size_t k = 0; k < size; ++k ) nm[k] = states[k];
+      if ( size ) {
+        __builtin_memcpy(ns, sets, size * words * sizeof(u64));
+        __builtin_memcpy(nh, hashes, size * sizeof(u64));
+      }
+      delete[] sets;
+      delete[] states;
+      delete[] hashes;
+      sets = ns;
+      states = nm;
+      hashes = nh;
+    }
+    __builtin_memcpy(sets + size * words, set, words * sizeof(u64));
+    states[size] = m;
+    hashes[size] = h;
+    slots[i] = static_cast<u32>(++size);
+    return true;
+  }
+
+  void
+  grow()
+  {
+    delete[] slots;
+    cap = cap ? cap * 2 : 1024;
+    slots = new u32[cap]{};
+    for ( size_t k = 0; k < size; ++k ) {
+      size_t i = hashes[k] & (cap - 1);
+      while ( slots[i] ) i = (i + 1) & (cap - 1);
+      slots[i] = static_cast<u32>(k + 1);
+    }
+  }
+};
+
+// whether the ops ids[0..n) of the history are linearizable with respect to init
+template <typename Op, typename Model>
+bool
+__wing_gong(const __lin_entry<Op> *ops, const u32 *ids, u32 n, const Model &init)
+{
+  if ( n == 0 ) return true;
+  struct stamp {
+    u64 ts;
+    u32 id;
+    bool ret;
+  };
+  stamp *order = new stamp[2 * n];
+  for ( u32 i = 0; i < n; ++i ) {
+    order[2 * i] = { ops[ids[i]].call, i, false };
+    order[2 * i + 1] = { ops[ids[i]].ret, i, true };
+  }
+  // on equal timestamps calls go first, which makes the ops concurrent: the permissive reading
+  __sort(order, 2 * static_cast<size_t>(n),
+         [](const stamp &a, const stamp &b) { return a.ts != b.ts ? a.ts < b.ts : (a.ret < b.ret); });
+  __lin_event *events = new __lin_event[2 * n + 1];
+  __lin_event *head = &events[2 * n];
+  __lin_event **calls = new __lin_event *[n];
+  *head = { ~0u, false, nullptr, nullptr, nullptr };
+  __lin_event *prev = head;
+  for ( u32 k = 0; k < 2 * n; ++k ) {
+    events[k] = { order[k].id, !order[k].ret, prev, nullptr, nullptr };
+    prev->next = &events[k];
+    prev = &events[k];
+    if ( !order[k].ret )
+      calls[order[k].id] = &events[k];
+    else
+      calls[order[k].id]->match = &events[k];
+  }
+  delete[] order;
+  delete[] calls;
+
+  auto lift = [](__lin_event *e) {
+    e->prev->next = e->next;
+    e->next->prev = e->prev;
+    __lin_event *m = e->match;
+    m->prev->next = m->next;
+    if ( m->next ) m->next->prev = m->prev;
+  };
+  auto unlift = [](__lin_event *e) {
+    __lin_event *m = e->match;
+    m->prev->next = m;
+    if ( m->next ) m->next->prev = m;
+    e->prev->next = e;
+    e->next->prev = e;
+  };
+
+  __lin_memo<Model> memo(n);
+  u64 *linearized = new u64[memo.words]{};
+  __lin_event **stack = new __lin_event *[n];
+  Model *saved = new Model[n];
+  Model state = init;
+  u64 lin_hash = 0;
+  u32 depth = 0;
+  bool ok = true;
+  __lin_event *e = head->next;
+  while ( head->next ) {
+    if ( e->call ) {
+      Model next = state;
+      bool fresh = next.step(ops[ids[e->id]].op);
+      const u64 h = lin_hash ^ __mix64(e->id + 1);
+      if constexpr ( __model_memoizable<Model> ) {
+        if ( fresh ) {
+          linearized[e->id / 64] |= 1ULL << (e->id % 64);
+          fresh = memo.insert(linearized, h, next);
+          if ( !fresh ) linearized[e->id / 64] &= ~(1ULL << (e->id % 64));
+        }
+      }
+      if ( fresh ) {
+        stack[depth] = e;
+        saved[depth] = state;
+        ++depth;
+        state = next;
+        lin_hash = h;
+        lift(e);
+        e = head->next;
+      } else {
+        e = e->next;
+      }
+    } else {
+      // an op returned before any order of the ops so far could explain it, backtrack
+      if ( depth == 0 ) {
+        ok = false;
+        break;
+      }
+      --depth;
+      e = stack[depth];
+      state = saved[depth];
+      lin_hash ^= __mix64(e->id + 1);
+      linearized[e->id / 64] &= ~(1ULL << (e->id % 64));
+      unlift(e);
+      e = e->next;
+    }
+  }
+  delete[] saved;
+  delete[] stack;
+  delete[] linearized;
+  delete[] events;
+  return ok;
+}
+
+// ids are in call order and the whole history fails: bisects over the responses for the first one
+// that the ops called before it can't explain. returns how many ops were called by then, culprit is
+// the offending op
+template <typename Op, typename Model>
+u32
+__lin_failing_prefix(const __lin_entry<Op> *ops, const u32 *ids, u32 n, const Model &init, u32 &culprit)
+{
+  u32 *by_ret = new u32[n];
+  __builtin_memcpy(by_ret, ids, n * sizeof(u32));
+  __sort(by_ret, n, [&](u32 a, u32 b) { return ops[a].ret < ops[b].ret; });
+  auto called_by = [&](u32 k) {
+    u32 m = 0;
+    while ( m < n && ops[ids[m]].call <= ops[by_ret[k]].ret ) ++m;
+    return m;
+  };
+  u32 lo = 0, hi = n - 1;
+  if ( !__wing_gong(ops, ids, called_by(0), init) ) hi = 0;
+  while ( hi - lo > 1 ) {
+    const u32 mid = lo + (hi - lo) / 2;
+    if ( __wing_gong(ops, ids, called_by(mid), init) )
+      lo = mid;
+    else
+      hi = mid;
+  }
+  culprit = by_ret[hi];
+  const u32 m = called_by(hi);
+  delete[] by_ret;
+  return m;
+}
+
+template <typename Op>
+void
+__print_op(const Op &op)
+{
+  if constexpr ( requires { op.print(); } )
+    op.print();
+  else
+    __print_element(op);
+}
+};     // namespace __impl
+
+template <typename Op> class history
+{
+  __impl::__lin_entry<Op> *__entries;
+  size_t *__counts;     // one cache line per thread
+  u32 __threads;
+  size_t __capacity;
+
+  static constexpr size_t __stride = 64 / sizeof(size_t);
+
+public:
+  history(u32 threads, size_t capacity_per_thread)
+      : __entries(new __impl::__lin_entry<Op>[static_cast<size_t>(threads) * capacity_per_thread]),
+        __counts(new size_t[static_cast<size_t>(threads) * __stride]{}), __threads(threads),
+        __capacity(capacity_per_thread)
+  {
+  }
+  ~history()
+  {
+    delete[] __entries;
+    delete[] __counts;
+  }
+  history(const history &) = delete;
+  history &operator=(const history &) = delete;
+
+  // op carries the input; returns the handle to respond() with
+  size_t
+  invoke(u32 thread, const Op &op)
+  {
+    size_t &n = __counts[thread * __stride];
+    if ( n == __capacity ) error("history::invoke(): per thread capacity exhausted");
+    __impl::__lin_entry<Op> &e = __entries[thread * __capacity + n];
+    e.op = op;
+    e.thread = thread;
+    e.ret = 0;
+    e.call = __impl::__ordered_cycles();
+    return n++;
+  }
+
+  // op carries the input and the output
+  void
+  respond(u32 thread, size_t handle, const Op &op)
+  {
+    const u64 t = __impl::__ordered_cycles();
+    __impl::__lin_entry<Op> &e = __entries[thread * __capacity + handle];
+    e.op = op;
+    e.ret = t;
+  }
+
+  void
+  clear()
+  {
+    for ( u32 t = 0; t < __threads; ++t ) __counts[t * __stride] = 0;
+  }
+
+  // completed ops, ops that never got a response are left out
+  u32
+  __collect(__impl::__lin_entry<Op> *&out) const
+  {
+    size_t total = 0;
+    for ( u32 t = 0; t < __threads; ++t ) total += __counts[t * __stride];
+    out = new __impl::__lin_entry<Op>[total ? total : 1];
+    u32 n = 0;
+    for ( u32 t = 0; t < __threads; ++t )
+      for ( size_t i = 0; i < __counts[t * __stride]; ++i )
+        if ( __entries[t * __capacity + i].ret ) out[n++] = __entries[t * __capacity + i];
+    return n;
+  }
+};
+
+namespace __impl
+{
+struct __no_partition {
+  template <typename Op>
+  u64
+  operator()(const Op &) const
+  {
+    return 0;
+  }
+};
+
+template <typename Op, typename Model, typename Part>
+bool
+__linearizable(const char *who, const history<Op> &h, const Model &model, Part &&partition)
+{
+  __lin_entry<Op> *ops = nullptr;
+  const u32 n = h.__collect(ops);
+  struct keyed {
+    u64 key;
+    u32 id;
+  };
+  keyed *order = new keyed[n ? n : 1];
+  for ( u32 i = 0; i < n; ++i ) order[i] = { static_cast<u64>(partition(ops[i].op)), i };
+  __sort(order, n, [](const keyed &a, const keyed &b) { return a.key != b.key ? a.key < b.key : a.id < b.id; });
+  u32 *ids = new u32[n ? n : 1];
+  bool ok = true;
+  for ( u32 start = 0; start < n && ok; ) {
+    u32 end = start;
+    while ( end < n && order[end].key == order[start].key ) ++end;
+    const u32 m = end - start;
+    for ( u32 i = 0; i < m; ++i ) ids[i] = order[start + i].id;
+    __sort(ids, m, [&](u32 a, u32 b) { return ops[a].call < ops[b].call; });
+    if ( !__wing_gong(ops, ids, m, model) ) {
+      ok = false;
+      u32 culprit = 0;
+      const u32 k = __lin_failing_prefix(ops, ids, m, model, culprit);
+      const u32 shown = k < config::__default_table_report ? k : static_cast<u32>(config::__default_table_report);
+      __print_error("\033[34msnowball ", who, " failure:\033[0m history of ", n,
+                    " ops is not linearizable, the marked response can't be explained by the ", k,
+                    " ops called before it, last ", shown, " shown (call .. return in cycles):\n\r");
+      const u64 base = ops[ids[k - shown]].call;
+      for ( u32 i = k - shown; i < k; ++i ) {
+        const __lin_entry<Op> &e = ops[ids[i]];
+        __print(ids[i] == culprit ? "> " : "  ", "[thread ", e.thread, "] ", e.call - base, " .. ", e.ret - base, ": ");
+        __print_op(e.op);
+        __print("\n\r");
+      }
+    }
+    start = end;
+  }
+  delete[] ids;
+  delete[] order;
+  delete[] ops;
+  return ok;
+}
+};     // namespace __impl
+
+template <typename Op, typename Model, typename Part = __impl::__no_partition>
+void
+require_linearizable(const history<Op> &h, const Model &model, Part &&partition = {})
+{
+  if ( !__impl::__linearizable("require_linearizable()", h, model, partition) ) {
+    should_print_stack();
+    __require_clbck();
+    __abort();
+  }
+}
+
+template <typename Op, typename Model, typename Part = __impl::__no_partition>
+void
+check_linearizable(const history<Op> &h, const Model &model, Part &&partition = {})
+{
+  if ( !__impl::__linearizable("check_linearizable()", h, model, partition) ) {
+    should_print_stack();
+    __check_clbck();
+  }
+}
+
+// async tests
+// task<T> is a lazily started coroutine. async_test() queues a test case, async_run() then interleaves
+// every queued case on the calling thread: ready coroutines are resumed in fifo order, and while none
+// are ready the thread sleeps in epoll_wait on the fds awaited through readable()/writable() and on a
+// single timerfd armed for the earliest delay() or timeout. waits overlap, so a run takes about as
+// long as its slowest case
+//
+// co_await co_require(v) ends only the awaiting case; async_run() aborts once every other case is done.
+// plain require() still aborts immediately. T of task<T> must be default constructible
+
+template <typename T = void> class task;
+
+namespace __impl
+{
+struct __async_case {
+  const char *name;
+  task<void> (*start)(__async_case *);
+  void (*release)(__async_case *);
+  __async_case *next;
+  std::coroutine_handle<> root;
+  std::coroutine_handle<> waiting;     // suspended on wait_fd
+  u64 timeout_ms;
+  int wait_fd;
+  u32 gen;     // bumped on cancellation, stale wakeups are dropped
+  bool done;
+  bool failed;
+};
+
+struct __ready {
+  std::coroutine_handle<> h;
+  __async_case *c;
+  u32 gen;
+};
+
+// h is empty for the deadline of c
+struct __timer {
+  u64 at;
+  std::coroutine_handle<> h;
+  __async_case *c;
+  u32 gen;
+};
+
+struct __loop {
+  __async_case *head = nullptr;
+  __async_case *tail = nullptr;
+  __async_case *current = nullptr;
+  __ready *ready = nullptr;     // ring
+  size_t ready_cap = 0;
+  size_t ready_head = 0;
+  size_t ready_count = 0;
+  __timer *timers = nullptr;     // min-heap on at
+  size_t timer_cap = 0;
+  size_t timer_count = 0;
+  int ep = -1;
+  int tfd = -1;
+  u32 live = 0;
+  u32 fd_waits = 0;
+  bool required_failed = false;
+
+  void
+  push_ready(std::coroutine_handle<> h, __async_case *c)
+  {
+    if ( ready_count == ready_cap ) {
+      const size_t cap = ready_cap ? ready_cap * 2 : 64;
+      __ready *grown = new __ready[cap];
+      for ( size_t i = 0; i < ready_count; ++i ) grown[i] = ready[(ready_head + i) % ready_cap];
+      delete[] ready;
+      ready = grown;
+      ready_cap = cap;
+      ready_head = 0;
+    }
+    ready[(ready_head + ready_count++) % ready_cap] = { h, c, c->gen };
+  }
+
+  bool
+  pop_ready(__ready &r)
+  {
+    if ( ready_count == 0 ) return false;
+    r = ready[ready_head];
+    ready_head = (ready_head + 1) % ready_cap;
+    --ready_count;
+    return true;
+  }
+
+  void
+  push_timer(u64 at, std::coroutine_handle<> h, __async_case *c)
+  {
+    if ( timer_count == timer_cap ) {
+      const size_t cap = timer_cap ? timer_cap * 2 : 64;
+      __timer *grown = new __timer[cap];
+      for ( size_t i = 0; i < timer_count; ++i ) grown[i] = timers[i];
+      delete[] timers;
+      timers = grown;
+      timer_cap = cap;
+    }
+    size_t i = timer_count++;
+    for ( ; i && timers[(i - 1) / 2].at > at; i = (i - 1) / 2 ) timers[i] = timers[(i - 1) / 2];
+    timers[i] = { at, h, c, c->gen };
+  }
+
+  __timer
+  pop_timer(void)
+  {
+    const __timer top = timers[0];
+    const __timer last = timers[--timer_count];
+    size_t i = 0;
+    for ( ;; ) {
+      size_t child = 2 * i + 1;
+      if ( child >= timer_count ) break;
+      if ( child + 1 < timer_count && timers[child + 1].at < timers[child].at ) ++child;
+      if ( last.at <= timers[child].at ) break;
+      timers[i] = timers[child];
+      i = child;
+    }
+    if ( timer_count ) timers[i] = last;
+    return top;
+  }
+
+  void
+  unwait(__async_case *c)
+  {
+    if ( c->wait_fd < 0 ) return;
+    ::epoll_ctl(ep, EPOLL_CTL_DEL, c->wait_fd, nullptr);
+    c->wait_fd = -1;
+    --fd_waits;
+  }
+
+  void
+  finish(__async_case *c, bool failed)
+  {
+    if ( c->done ) return;
+    c->done = true;
+    c->failed |= failed;
+    ++c->gen;
+    unwait(c);
+    --live;
+  }
+
+  // reports a failure of c outside of any of its frames
+  template <typename... T>
+  void
+  fail(__async_case *c, const T &...msg)
+  {
+    const char *prev = __tls_case_name;
+    __tls_case_name = c->name;
+    __print_error("\033[34msnowball async_test() failure:\033[0m ", msg..., "\n\r");
+    __require_clbck();
+    __tls_case_name = prev;
+    required_failed = true;
+    finish(c, true);
+  }
+};
+
+inline __loop __async_loop;
+
+// the case being run; awaiting outside of async_run() has no loop to resume the awaiter
+inline __async_case *
+__async_current(const char *who)
+{
+  __async_case *c = __async_loop.current;
+  if ( c == nullptr ) [[unlikely]] {
+    __print_error("\033[34msnowball ", who, " failure:\033[0m awaited outside of async_run().\n\r");
+    should_print_stack();
+    __require_clbck();
+    __abort();
+  }
+  return c;
+}
+
+struct __promise_base {
+  std::coroutine_handle<> continuation{};
+
+  std::suspend_always
+  initial_suspend() noexcept
+  {
+    return {};
+  }
+
+  struct final_awaiter {
+    bool
+    await_ready() noexcept
+    {
+      return false;
+    }
+
+    template <typename P>
+    std::coroutine_handle<>
+    await_suspend(std::coroutine_handle<P> h) noexcept
+    {
+      __async_case *c = __async_loop.current;
+      const std::coroutine_handle<> cont = h.promise().continuation;
+      if ( c == nullptr || c->done ) return std::noop_coroutine();
+      if ( cont ) return cont;
+      __async_loop.finish(c, false);     // the root returned
+      return std::noop_coroutine();
+    }
+
+    void
+    await_resume() noexcept
+    {
+    }
+  };
+
+  final_awaiter
+  final_suspend() noexcept
+  {
+    return {};
+  }
+
+  void
+  unhandled_exception() noexcept
+  {
+    if ( __async_case *c = __async_loop.current ) __async_loop.fail(c, "uncaught exception.");
+  }
+};
+
+template <typename T> struct __task_promise : __promise_base {
+  T value{};
+
+  task<T> get_return_object() noexcept;
+
+  void
+  return_value(T v)
+  {
+    value = micron::move(v);
+  }
+};
+
+template <> struct __task_promise<void> : __promise_base {
+  task<void> get_return_object() noexcept;
+
+  void
+  return_void() noexcept
+  {
+  }
+};
+};     // namespace __impl
+
+template <typename T> class task
+{
+public:
+  using promise_type = __impl::__task_promise<T>;
+
+  explicit task(std::coroutine_handle<promise_type> h) noexcept : __h(h) {}
+  task(task &&o) noexcept : __h(o.__h) { o.__h = {}; }
+  task(const task &) = delete;
+  task &operator=(const task &) = delete;
+  ~task()
+  {
+    if ( __h ) __h.destroy();
+  }
+
+  bool
+  await_ready() const noexcept
+  {
+    return !__h || __h.done();
+  }
+
+  std::coroutine_handle<>
+  await_suspend(std::coroutine_handle<> parent) noexcept
+  {
+    __h.promise().continuation = parent;
+    return __h;
+  }
+
+  T
+  await_resume()
+  {
+    if constexpr ( !micron::is_void_v<T> ) return micron::move(__h.promise().value);
+  }
+
+  std::coroutine_handle<>
+  __release(void) noexcept
+  {
+    std::coroutine_handle<> h = __h;
+    __h = {};
+    return h;
+  }
+
+private:
+  std::coroutine_handle<promise_type> __h;
+};
+
+namespace __impl
+{
+template <typename T>
+task<T>
+__task_promise<T>::get_return_object() noexcept
+{
+  return task<T>{ std::coroutine_handle<__task_promise<T>>::from_promise(*this) };
+}
+
+inline task<void>
+__task_promise<void>::get_return_object() noexcept
+{
+  return task<void>{ std::coroutine_handle<__task_promise<void>>::from_promise(*this) };
+}
+
+struct __delay {
+  u64 ns;
+
+  bool
+  await_ready() const noexcept
+  {
+    return ns == 0;
+  }
+
+  void
+  await_suspend(std::coroutine_handle<> h)
+  {
+    __async_loop.push_timer(__now_ns() + ns, h, __async_current("delay()"));
+  }
+
+  void
+  await_resume() const noexcept
+  {
+  }
+};
+
+struct __yield {
+  bool
+  await_ready() const noexcept
+  {
+    return false;
+  }
+
+  void
+  await_suspend(std::coroutine_handle<> h)
+  {
+    __async_loop.push_ready(h, __async_current("yield()"));
+  }
+
+  void
+  await_resume() const noexcept
+  {
+  }
+};
+
+struct __fd_wait {
+  int fd;
+  u32 events;
+
+  bool
+  await_ready() const noexcept
+  {
+    return false;
+  }
+
+  bool
+  await_suspend(std::coroutine_handle<> h)
+  {
+    __async_case *c = __async_current(events & EPOLLIN ? "readable()" : "writable()");
+    epoll_event ev{};
+    ev.events = events | EPOLLONESHOT;
+    ev.data.ptr = c;
+    if ( ::epoll_ctl(__async_loop.ep, EPOLL_CTL_ADD, fd, &ev) != 0 ) {
+      if ( errno == EPERM ) return false;     // regular files are always ready
+      error("async_test(): can't wait on fd, is another case waiting on it?");
+    }
+    c->wait_fd = fd;
+    c->waiting = h;
+    ++__async_loop.fd_waits;
+    return true;
+  }
+
+  void
+  await_resume() const noexcept
+  {
+  }
+};
+
+struct __co_assert {
+  bool ok;
+  bool require;
+
+  bool
+  await_ready() const noexcept
+  {
+    return ok;
+  }
+
+  bool
+  await_suspend(std::coroutine_handle<>)
+  {
+    __async_case *c = __async_current(require ? "co_require()" : "co_check()");
+    __print_error("\033[34msnowball ", require ? "co_require()" : "co_check()",
+                  " failure:\033[0m expected output was false.\n\r");
+    should_print_stack();
+    if ( !require ) {
+      __check_clbck();
+      c->failed = true;
+      return false;
+    }
+    __require_clbck();
+    __async_loop.required_failed = true;
+    __async_loop.finish(c, true);     // never resumed, destroyed by async_run()
+    return true;
+  }
+
+  void
+  await_resume() const noexcept
+  {
+  }
+};
+
+template <typename Fn> struct __async_holder : __async_case {
+  Fn fn;
+
+  static task<void>
+  start(__async_case *c)
+  {
+    return static_cast<__async_holder *>(c)->fn();
+  }
+
+  static void
+  release(__async_case *c)
+  {
+    delete static_cast<__async_holder *>(c);
+  }
+};
+};     // namespace __impl
+
+// suspends the awaiting case for ms milliseconds
+inline __impl::__delay
+delay(u64 ms)
+{
+  return { ms * 1000000ULL };
+}
+
+// lets every other ready case run first
+inline __impl::__yield
+yield(void)
+{
+  return {};
+}
+
+inline __impl::__fd_wait
+readable(int fd)
+{
+  return { fd, EPOLLIN | EPOLLRDHUP };
+}
+
+inline __impl::__fd_wait
+writable(int fd)
+{
+  return { fd, EPOLLOUT };
+}
+
+inline __impl::__co_assert
+co_require(bool v)
+{
+  return { v, true };
+}
+
+inline __impl::__co_assert
+co_check(bool v)
+{
+  return { v, false };
+}
+
+// queues fn(), which returns a task<>, to run on the next async_run(); fn is kept alive until then.
+// a case still running after timeout_ms (0 for none) fails and is cancelled
+template <typename Fn>
+  requires(micron::is_invocable_v<Fn &>)
+void
+async_test(const char *name, Fn &&fn, u64 timeout_ms = config::__default_async_timeout_ms)
+{
+  using holder = __impl::__async_holder<micron::decay_t<Fn>>;
+  holder *c = new holder{ { name, &holder::start, &holder::release, nullptr, {}, {}, timeout_ms, -1, 0, false, false },
+                          micron::forward<Fn>(fn) };
+  __impl::__loop &l = __impl::__async_loop;
+  if ( l.tail )
+    l.tail->next = c;
+  else
+    l.head = c;
+  l.tail = c;
+}
+
+// runs every queued case to completion, returns how many failed
+inline u32
+async_run(void)
+{
+  __impl::__loop &l = __impl::__async_loop;
+  if ( l.head == nullptr ) return 0;
+  l.ep = ::epoll_create1(EPOLL_CLOEXEC);
+  l.tfd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if ( l.ep < 0 || l.tfd < 0 ) error("async_run(): couldn't create the epoll/timerfd descriptors");
+  epoll_event tev{};
+  tev.events = EPOLLIN;
+  tev.data.ptr = nullptr;
+  ::epoll_ctl(l.ep, EPOLL_CTL_ADD, l.tfd, &tev);
+
+  const u64 start = __impl::__now_ns();
+  u32 cases = 0;
+  for ( __impl::__async_case *c = l.head; c; c = c->next ) {
+    c->root = c->start(c).__release();
+    ++cases;
+    ++l.live;
+    l.push_ready(c->root, c);
+    if ( c->timeout_ms ) l.push_timer(start + c->timeout_ms * 1000000ULL, {}, c);
+  }
+
+  epoll_event events[64];
+  while ( l.live ) {
+    __impl::__ready r;
+    while ( l.pop_ready(r) ) {
+      if ( r.c->done || r.gen != r.c->gen ) continue;
+      l.current = r.c;
+      __impl::__tls_case_name = r.c->name;
+      r.h.resume();
+      __impl::__tls_case_name = nullptr;
+      l.current = nullptr;
+    }
+    if ( l.live == 0 ) break;
+
+    bool fired = false;
+    for ( const u64 now = __impl::__now_ns(); l.timer_count && l.timers[0].at <= now; ) {
+      const __impl::__timer t = l.pop_timer();
+      if ( t.c->done || t.gen != t.c->gen ) continue;
+      fired = true;
+      if ( t.h )
+        l.push_ready(t.h, t.c);
+      else
+        l.fail(t.c, "timed out after ", t.c->timeout_ms, " ms.");
+    }
+    if ( fired ) continue;
+
+    if ( l.timer_count == 0 && l.fd_waits == 0 ) {
+      // suspended on something other than snowball's awaitables, nothing will ever resume them
+      for ( __impl::__async_case *c = l.head; c; c = c->next )
+        if ( !c->done ) l.fail(c, "suspended with nothing left to resume it.");
+      break;
+    }
+    itimerspec its{};
+    if ( l.timer_count ) {
+      its.it_value.tv_sec = static_cast<time_t>(l.timers[0].at / 1000000000ULL);
+      its.it_value.tv_nsec = static_cast<long>(l.timers[0].at % 1000000000ULL);
+    }
+    ::timerfd_settime(l.tfd, TFD_TIMER_ABSTIME, &its, nullptr);
+    const int n = ::epoll_wait(l.ep, events, 64, -1);
+    for ( int i = 0; i < n; ++i ) {
+      __impl::__async_case *c = static_cast<__impl::__async_case *>(events[i].data.ptr);
+      if ( c == nullptr ) {
+        u64 expirations;
+        while ( ::read(l.tfd, &expirations, sizeof(expirations)) > 0 ) {
+        }
+      } else if ( !c->done && c->wait_fd >= 0 ) {
+        l.unwait(c);
+        l.push_ready(c->waiting, c);
+      }
+    }
+  }
+
+  u32 failed = 0;
+  for ( __impl::__async_case *c = l.head; c; ) {
+    __impl::__async_case *next = c->next;
+    failed += c->failed;
+    c->root.destroy();
+    c->release(c);
+    c = next;
+  }
+  __print("\033[34msnowball async:\033[0m ", cases, " case(s), ", failed, " failed, in ");
+  __impl::__print_fixed(static_cast<double>(__impl::__now_ns() - start) / 1e6);
+  __print(" ms\n\r");
+  ::close(l.tfd);
+  ::close(l.ep);
+  delete[] l.ready;
+  delete[] l.timers;
+  const bool required_failed = l.required_failed;
+  l = __impl::__loop{};
+  if ( required_failed ) __abort();
+  return failed;
+}
+
+// benchmarking
+// samples are cycles per iteration, stored in a small binary baseline file keyed on
+// fnv1a(name, cpu brand, compiler version); later runs are compared with a Mann-Whitney U test
+
+namespace __impl
+{
+inline u64
+__fnv1a(const void *ptr, size_t len, u64 h = 0xcbf29ce484222325ULL) noexcept
+{
+  const u8 *p = static_cast<const u8 *>(ptr);
+  for ( size_t i = 0; i < len; ++i ) {
+    h ^= p[i];
+    h *= 0x100000001b3ULL;
+  }
+  return h;
+}
+
+inline u8 *
+__read_file(const char *path, size_t &len)
+{
+  len = 0;
+  int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if ( fd < 0 ) return nullptr;
+  off_t sz = ::lseek(fd, 0, SEEK_END);
+  if ( sz <= 0 || ::lseek(fd, 0, SEEK_SET) != 0 ) {
+    ::close(fd);
+    return nullptr;
+  }
+  u8 *buf = new u8[static_cast<size_t>(sz)];
+  while ( len < static_cast<size_t>(sz) ) {
+    ssize_t r = ::read(fd, buf + len, static_cast<size_t>(sz) - len);
+    if ( r <= 0 ) break;
+    len += static_cast<size_t>(r);
+  }
+  ::close(fd);
+  return buf;
+}
+
+// write-then-rename, a crashed run never leaves a truncated file behind
+inline bool
+__write_file(const char *path, const u8 *buf, size_t len)
+{
+  char tmp[4096];
+  size_t n = __builtin_strlen(path);
+  if ( n + sizeof(".tmp") > sizeof(tmp) ) return false;
+  __builtin_memcpy(tmp, path, n);
+  __builtin_memcpy(tmp + n, ".tmp", sizeof(".tmp"));
+  int fd = ::open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if ( fd < 0 ) return false;
+  size_t put = 0;
+  while ( put < len ) {
+    ssize_t r = ::write(fd, buf + put, len - put);
+    if ( r <= 0 ) break;
+    put += static_cast<size_t>(r);
+  }
+  ::close(fd);
+  if ( put != len ) return false;
+  return ::syscall(SYS_renameat, AT_FDCWD, tmp, AT_FDCWD, path) == 0;
+}
+
+inline u64
+__machine_fingerprint() noexcept
+{
+  u64 h = __fnv1a(__VERSION__, sizeof(__VERSION__) - 1);
+#if defined(__OPTIMIZE__)
+  h = __fnv1a("O", 1, h);
+#endif
+#if defined(__micron_arch_amd64)
+  // cpu brand string
+  for ( u32 leaf = 0x80000002; leaf <= 0x80000004; ++leaf ) {
+    u32 regs[4];
+    asm volatile("cpuid" : "=a"(regs[0]), "=b"(regs[1]), "=c"(regs[2]), "=d"(regs[3]) : "a"(leaf), "c"(0));
+    h = __fnv1a(regs, sizeof(regs), h);
+  }
+#elif defined(__micron_arch_arm64)
+  // emulated for userspace by the kernel
+  u64 midr;
+  asm volatile("mrs %0, midr_el1" : "=r"(midr));
+  h = __fnv1a(&midr, sizeof(midr), h);
+#endif
+  return h;
+}
+
+template <typename T>
+[[gnu::always_inline]] inline void
+__do_not_optimize(T &v) noexcept
+{
+  asm volatile("" : : "g"(&v) : "memory");
+}
+
+template <typename Fn>
+[[gnu::always_inline]] inline void
+__bench_invoke(Fn &fn)
+{
+  if constexpr ( micron::is_void_v<decltype(fn())> ) {
+    fn();
+    asm volatile("" : : : "memory");
+  } else {
+    auto r = fn();
+    __do_not_optimize(r);
+  }
+}
+
+constexpr static const u32 __bench_magic = 0x4c424253;     // "SBBL"
+constexpr static const u32 __bench_version = 1;
+
+struct __bench_record {
+  u64 key;
+  u32 count;
+  u32 reserved;
+  // followed by count f64 samples
+};
+
+struct __bench_stats {
+  double z;
+  double speedup;
+  double lo;
+  double hi;
+};
+
+// returns the offset of the record for key in a baseline file, or 0 if absent/malformed
+inline size_t
+__bench_find(const u8 *buf, size_t len, u64 key, __bench_record &out)
+{
+  if ( buf == nullptr || len < 8 ) return 0;
+  u32 head[2];
+  __builtin_memcpy(head, buf, sizeof(head));
+  if ( head[0] != __bench_magic || head[1] != __bench_version ) return 0;
+  size_t off = 8;
+  while ( off + sizeof(__bench_record) <= len ) {
+    __builtin_memcpy(&out, buf + off, sizeof(__bench_record));
+    size_t body = static_cast<size_t>(out.count) * sizeof(double);
+    if ( off + sizeof(__bench_record) + body > len ) return 0;
+    if ( out.key == key ) return off;
+    off += sizeof(__bench_record) + body;
+  }
+  return 0;
+}
+
+// doubles mapped to integers in the same order, so a bisection over them takes at most 64 steps
+inline u64
+__ordered_key(double d) noexcept
+{
+  const u64 bits = __builtin_bit_cast(u64, d);
+  return bits >> 63 ? ~bits : bits | (1ULL << 63);
+}
+
+inline double
+__ordered_value(u64 key) noexcept
+{
+  return __builtin_bit_cast(double, key >> 63 ? key & ~(1ULL << 63) : ~key);
+}
+
+// the k-th smallest (0-based) of the n1 * n2 differences a[i] - b[j] of two sorted arrays, without
+// building them: bisects on the value, counting the differences at most x in one merge-like pass
+inline double
+__select_difference(const double *a, u32 n1, const double *b, u32 n2, u64 k)
+{
+  auto at_most = [&](double x) {
+    u64 count = 0;
+    u32 j = 0;     // a[i] - b[j] <= x for j and every later j, a[i] only grows
+    for ( u32 i = 0; i < n1; ++i ) {
+      while ( j < n2 && !(a[i] - b[j] <= x) ) ++j;
+      count += n2 - j;
+    }
+    return count;
+  };
+  u64 lo = __ordered_key(a[0] - b[n2 - 1]), hi = __ordered_key(a[n1 - 1] - b[0]);
+  while ( lo < hi ) {
+    const u64 mid = lo + (hi - lo) / 2;
+    if ( at_most(__ordered_value(mid)) > k )
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+  return __ordered_value(lo);
+}
+
+// z > 0 means cur is slower than base; speedup is the Hodges-Lehmann estimate of base / cur
+inline __bench_stats
+__mann_whitney(const double *base, u32 n1, const double *cur, u32 n2)
+{
+  struct ranked {
+    double v;
+    bool cur;
+  };
+  const size_t n = static_cast<size_t>(n1) + n2;
+  ranked *pool = new ranked[n];
+  for ( u32 i = 0; i < n1; ++i ) pool[i] = { base[i], false };
+  for ( u32 i = 0; i < n2; ++i ) pool[n1 + i] = { cur[i], true };
+  __sort(pool, n, [](const ranked &a, const ranked &b) { return a.v < b.v; });
+
+  double rank_cur = 0.0, ties = 0.0;
+  for ( size_t i = 0; i < n; ) {
+    size_t j = i + 1;
+    while ( j < n && !(pool[i].v < pool[j].v) ) ++j;
+    double avg = static_cast<double>(i + j + 1) / 2.0;
+    double t = static_cast<double>(j - i);
+    ties += t * t * t - t;
+    for ( size_t k = i; k < j; ++k )
+      if ( pool[k].cur ) rank_cur += avg;
+    i = j;
+  }
+  delete[] pool;
+
+  const double a = n1, b = n2, nn = a + b;
+  double u = rank_cur - b * (b + 1.0) / 2.0;
+  double mean = a * b / 2.0;
+  double var = a * b / 12.0 * ((nn + 1.0) - ties / (nn * (nn - 1.0)));
+  __bench_stats st{};
+  st.z = var > 0.0 ? (u - mean - (u > mean ? 0.5 : -0.5)) / __builtin_sqrt(var) : 0.0;
+
+  // pairwise log ratios, the 95% interval comes from the same U distribution; they're selected from
+  // the sorted logs rather than materialized, which would take n1 * n2 doubles
+  double *logs = new double[n];
+  for ( u32 i = 0; i < n1; ++i ) logs[i] = __builtin_log(base[i]);
+  for ( u32 j = 0; j < n2; ++j ) logs[n1 + j] = __builtin_log(cur[j]);
+  __sort(logs, n1);
+  __sort(logs + n1, n2);
+  auto diff = [&](u64 k) { return __select_difference(logs, n1, logs + n1, n2, k); };
+  const u64 m = static_cast<u64>(n1) * n2;
+  double kf = a * b / 2.0 - 1.96 * __builtin_sqrt(a * b * (nn + 1.0) / 12.0);
+  u64 k = kf > 0.0 ? static_cast<u64>(kf) : 0;
+  if ( k >= m / 2 ) k = 0;
+  st.speedup = __builtin_exp(m % 2 ? diff(m / 2) : (diff(m / 2 - 1) + diff(m / 2)) / 2.0);
+  st.lo = __builtin_exp(diff(k));
+  st.hi = __builtin_exp(diff(m - 1 - k));
+  delete[] logs;
+  return st;
+}
+
+inline void
+__bench_store(const char *path, const u8 *old, size_t old_len, size_t rec_off, u64 key, const double *cur, u32 n)
+{
+  // drops the old record (if any) and appends the current one
+  __bench_record skip{};
+  size_t skip_len = 0;
+  if ( rec_off ) {
+    __builtin_memcpy(&skip, old + rec_off, sizeof(skip));
+    skip_len = sizeof(__bench_record) + static_cast<size_t>(skip.count) * sizeof(double);
+  }
+  bool valid = false;
+  if ( old != nullptr && old_len >= 8 ) {
+    u32 head[2];
+    __builtin_memcpy(head, old, sizeof(head));
+    valid = head[0] == __bench_magic && head[1] == __bench_version;
+  }
+  size_t keep = valid ? old_len - skip_len : 8;
+  size_t len = keep + sizeof(__bench_record) + static_cast<size_t>(n) * sizeof(double);
+  u8 *buf = new u8[len];
+  if ( valid ) {
+    size_t first = rec_off ? rec_off : old_len;
+    __builtin_memcpy(buf, old, first);
+    if ( rec_off ) __builtin_memcpy(buf + first, old + rec_off + skip_len, old_len - rec_off - skip_len);
+  } else {
+    u32 head[2] = { __bench_magic, __bench_version };
+    __builtin_memcpy(buf, head, sizeof(head));
+  }
+  __bench_record rec{ key, n, 0 };
+  __builtin_memcpy(buf + keep, &rec, sizeof(rec));
+  __builtin_memcpy(buf + keep + sizeof(rec), cur, static_cast<size_t>(n) * sizeof(double));
+  if ( !__write_file(path, buf, len) ) __print("\033[34msnowball warning:\033[0m couldn't write bench baseline.\n\r");
+  delete[] buf;
+}
+
+inline double
+__median(double *v, size_t n)
+{
+  __sort(v, n);
+  return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2.0;
+}
+
+inline void
+__bench_report(const char *name, const double *cur, u32 n)
+{
+  double *scratch = new double[n];
+  __builtin_memcpy(scratch, cur, static_cast<size_t>(n) * sizeof(double));
+  __print("\033[34msnowball bench:\033[0m ", name, " :: ");
+  __print_fixed(__median(scratch, n));
+  __print(" cycles/iter (", n, " samples)\n\r");
+  delete[] scratch;
+
+  if ( __global_bench_baseline == nullptr ) return;
+  const u64 key = __fnv1a(name, __builtin_strlen(name), __machine_fingerprint());
+  size_t len = 0;
+  u8 *file = __read_file(__global_bench_baseline, len);
+  __bench_record rec{};
+  size_t off = __bench_find(file, len, key, rec);
+  bool regressed = false;
+  if ( off ) {
+    double *base = new double[rec.count];
+    __builtin_memcpy(base, file + off + sizeof(__bench_record), static_cast<size_t>(rec.count) * sizeof(double));
+    __bench_stats st = __mann_whitney(base, rec.count, cur, n);
+    __print("  vs baseline ");
+    __print_fixed(__median(base, rec.count));
+    __print(" cycles/iter: speedup ");
+    __print_fixed(st.speedup, 3);
+    __print("x [");
+    __print_fixed(st.lo, 3);
+    __print("x, ");
+    __print_fixed(st.hi, 3);
+    __print("x], z = ");
+    __print_fixed(st.z);
+    __print("\n\r");
+    delete[] base;
+    regressed = st.z > config::__default_bench_z && st.speedup < 1.0 - config::__default_bench_tolerance;
+  }
+  if ( !off || __global_bench_update ) __bench_store(__global_bench_baseline, file, len, off, key, cur, n);
+  delete[] file;
+  if ( regressed ) {
+    __print_error("\033[34msnowball bench() failure:\033[0m statistically significant regression in ", name, ".\n\r");
+    __require_clbck();
+    __abort();
+  }
+}
+};     // namespace __impl
+
+// runs fn in calibrated batches and records the cycles per call of each batch
+template <typename Fn>
+void
+bench(const char *name, Fn &&fn, size_t samples = config::__default_bench_samples)
+{
+  if ( samples < 2 ) samples = 2;
+  u64 iters = 1;
+  for ( ;; ) {
+    u64 t0 = __impl::__cycle_counter();
+    for ( u64 i = 0; i < iters; ++i ) __impl::__bench_invoke(fn);
+    u64 t = __impl::__cycle_counter() - t0;
+    if ( t >= config::__default_bench_sample_cycles || iters >= (1ULL << 24) ) break;
+    iters <<= 1;
+  }
+  double *cur = new double[samples];
+  for ( size_t s = 0; s < samples; ++s ) {
+    u64 t0 = __impl::__cycle_counter();
+    for ( u64 i = 0; i < iters; ++i ) __impl::__bench_invoke(fn);
+    u64 t = __impl::__cycle_counter() - t0;
+    cur[s] = static_cast<double>(t) / static_cast<double>(iters);
+  }
+  __impl::__bench_report(name, cur, static_cast<u32>(samples));
+  delete[] cur;
+}
+
+// test case sharding
+// test cases passed as callables can be split across processes with shard(i, n); the split is a
+// longest-processing-time assignment over the durations in the timings file of the previous run,
+// so every shard computes the same plan independently. cases missing from the file are added to it
+// as they are reached, at the mean known duration.
+// sharded runs write their durations to "<timings>.<i>"; concatenate those into the timings file for
+// the next run
+
+namespace __impl
+{
+struct __timing {
+  char *name;
+  u64 hash;
+  u64 us;
+};
+
+struct __timing_list {
+  __timing *data = nullptr;
+  size_t size = 0;
+  size_t cap = 0;
+
+  void
+  push(const char *name, size_t len, u64 us)
+  {
+    if ( size == cap ) {
+      cap = cap ? cap * 2 : 64;
+      __timing *n = new __timing[cap];
+      if ( size ) __builtin_memcpy(n, data, size * sizeof(__timing));
+      delete[] data;
+      data = n;
+    }
+    char *copy = new char[len + 1];
+    __builtin_memcpy(copy, name, len);
+    copy[len] = 0;
+    data[size++] = { copy, __fnv1a(name, len), us };
+  }
+
+  __timing *
+  find(u64 hash) const
+  {
+    for ( size_t i = 0; i < size; ++i )
+      if ( data[i].hash == hash ) return &data[i];
+    return nullptr;
+  }
+};
+
+// one line per test case: "<microseconds> <name>\n"
+inline void
+__timings_parse(const u8 *buf, size_t len, __timing_list &out)
+{
+  size_t i = 0;
+  while ( i < len ) {
+    u64 us = 0;
+    bool digits = false;
+    while ( i < len && buf[i] >= '0' && buf[i] <= '9' ) {
+      us = us * 10 + (buf[i++] - '0');
+      digits = true;
+    }
+    if ( i < len && buf[i] == ' ' ) ++i;
+    size_t start = i;
+    while ( i < len && buf[i] != '\n' ) ++i;
+    if ( digits && i > start ) {
+      // later lines win, so per-shard files can simply be concatenated
+      const char *name = reinterpret_cast<const char *>(buf + start);
+      if ( __timing *t = out.find(__fnv1a(name, i - start)) )
+        t->us = us;
+      else
+        out.push(name, i - start, us);
+    }
+    ++i;
+  }
+}
+
+inline bool
+__sorted_contains(const u64 *v, size_t n, u64 h)
+{
+  size_t lo = 0, hi = n;
+  while ( lo < hi ) {
+    size_t mid = (lo + hi) / 2;
+    if ( v[mid] < h )
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo < n && v[lo] == h;
+}
+
+struct __shard_plan {
+  bool built = false;
+  u64 *mine = nullptr;     // sorted name hashes assigned to this shard
+  size_t size = 0;
+  __timing_list known;
+  __timing_list placed;     // cases missing from the timings file, us holds the shard they went to
+  u64 *load = nullptr;      // planned microseconds per shard
+  u64 estimate = 1;         // cost assumed for a case missing from the timings file
+};
+
+inline __shard_plan __global_shard_plan{};
+inline __timing_list __global_timings_run{};
+
+inline void
+__shard_build(__shard_plan &plan)
+{
+  plan.built = true;
+  if ( __global_timings == nullptr ) return;
+  size_t len = 0;
+  u8 *buf = __read_file(__global_timings, len);
+  if ( buf ) __timings_parse(buf, len, plan.known);
+  delete[] buf;
+  if ( __global_shard_count < 2 ) return;
+  plan.load = new u64[__global_shard_count]{};
+  if ( plan.known.size == 0 ) return;
+
+  __timing *order = new __timing[plan.known.size];
+  __builtin_memcpy(order, plan.known.data, plan.known.size * sizeof(__timing));
+  __sort(order, plan.known.size,
+         [](const __timing &a, const __timing &b) { return a.us != b.us ? a.us > b.us : a.hash < b.hash; });
+  u64 *load = plan.load;
+  u64 total = 0;
+  plan.mine = new u64[plan.known.size];
+  for ( size_t i = 0; i < plan.known.size; ++i ) {
+    u32 bin = 0;
+    for ( u32 b = 1; b < __global_shard_count; ++b )
+      if ( load[b] < load[bin] ) bin = b;
+    load[bin] += order[i].us + 1;
+    total += order[i].us + 1;
+    if ( bin == __global_shard_index ) plan.mine[plan.size++] = order[i].hash;
+  }
+  plan.estimate = total / plan.known.size;
+  __sort(plan.mine, plan.size);
+  delete[] order;
+}
+
+// a case missing from the timings file goes to the least loaded shard at the mean known cost. every
+// shard reaches the test cases in the same order, so they all place it on the same one
+inline u32
+__shard_place(__shard_plan &plan, const char *name, u64 h)
+{
+  if ( const __timing *t = plan.placed.find(h) ) return static_cast<u32>(t->us);
+  u32 bin = 0;
+  for ( u32 b = 1; b < __global_shard_count; ++b )
+    if ( plan.load[b] < plan.load[bin] ) bin = b;
+  plan.load[bin] += plan.estimate;
+  plan.placed.push(name, __builtin_strlen(name), bin);
+  return bin;
+}
+
+inline bool
+__shard_owns(const char *name)
+{
+  if ( !__global_shard_plan.built ) __shard_build(__global_shard_plan);
+  if ( __global_shard_count < 2 ) return true;
+  const u64 h = __fnv1a(name, __builtin_strlen(name));
+  if ( __global_shard_plan.known.find(h) == nullptr )
+    return __shard_place(__global_shard_plan, name, h) == __global_shard_index;
+  return __sorted_contains(__global_shard_plan.mine, __global_shard_plan.size, h);
+}
+
+// merges this run's durations into the timings file, locked so concurrent shards don't lose updates
+inline void
+__timings_flush(void)
+{
+  if ( __global_timings == nullptr || __global_timings_run.size == 0 ) return;
+  // sharded runs must not touch the file the other shards plan from
+  char path[4096];
+  size_t n = __builtin_strlen(__global_timings);
+  if ( n + 12 > sizeof(path) ) return;
+  __builtin_memcpy(path, __global_timings, n + 1);
+  if ( __global_shard_count > 1 ) {
+    char digits[11];
+    u32 v = __global_shard_index, k = sizeof(digits) - 1;
+    digits[k] = 0;
+    do {
+      digits[--k] = static_cast<char>('0' + v % 10);
+      v /= 10;
+    } while ( v );
+    path[n] = '.';
+    __builtin_memcpy(path + n + 1, digits + k, sizeof(digits) - k);
+  }
+  int fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if ( fd < 0 ) return;
+  ::flock(fd, LOCK_EX);
+  __timing_list merged;
+  off_t sz = ::lseek(fd, 0, SEEK_END);
+  if ( sz > 0 ) {
+    u8 *buf = new u8[static_cast<size_t>(sz)];
+    ssize_t r = ::pread(fd, buf, static_cast<size_t>(sz), 0);
+    if ( r > 0 ) __timings_parse(buf, static_cast<size_t>(r), merged);
+    delete[] buf;
+  }
+  for ( size_t i = 0; i < __global_timings_run.size; ++i ) {
+    const __timing &t = __global_timings_run.data[i];
+    if ( __timing *old = merged.find(t.hash) )
+      old->us = t.us;
+    else
+      merged.push(t.name, __builtin_strlen(t.name), t.us);
+  }
+  size_t len = 0;
+  for ( size_t i = 0; i < merged.size; ++i ) len += 21 + __builtin_strlen(merged.data[i].name) + 1;
+  char *out = new char[len];
+  size_t pos = 0;
+  for ( size_t i = 0; i < merged.size; ++i ) {
+    char digits[20];
+    int nd = 0;
+    u64 v = merged.data[i].us;
+    do {
+      digits[nd++] = static_cast<char>('0' + v % 10);
+      v /= 10;
+    } while ( v );
+    while ( nd ) out[pos++] = digits[--nd];
+    out[pos++] = ' ';
+    size_t nl = __builtin_strlen(merged.data[i].name);
+    __builtin_memcpy(out + pos, merged.data[i].name, nl);
+    pos += nl;
+    out[pos++] = '\n';
+  }
+  if ( ::ftruncate(fd, 0) == 0 && ::pwrite(fd, out, pos, 0) != static_cast<ssize_t>(pos) )
+    __print("\033[34msnowball warning:\033[0m couldn't write test case timings.\n\r");
+  delete[] out;
+  ::flock(fd, LOCK_UN);
+  ::close(fd);
+}
+
+inline bool __global_timings_hooked = false;
+// the test case being timed, recorded by __timings_on_exit() if it fails out of the process
+inline const char *__global_timed_case = nullptr;
+inline u64 __global_timed_start = 0;
+
+inline void
+__timings_record(const char *name, u64 us)
+{
+  if ( __global_timings == nullptr ) return;
+  if ( !__global_timings_hooked ) {
+    __global_timings_hooked = true;
+    ::atexit(&__timings_flush);
+  }
+  __global_timings_run.push(name, __builtin_strlen(name), us);
+}
+
+// failing shards are the ones that most need rebalancing, so their timings are kept too
+inline void
+__timings_on_exit(void)
+{
+  if ( __global_timings == nullptr ) return;
+  const char *name = __atomic_exchange_n(&__global_timed_case, static_cast<const char *>(nullptr), __ATOMIC_ACQ_REL);
+  if ( name != nullptr )
+    __global_timings_run.push(name, __builtin_strlen(name), (__now_ns() - __global_timed_start) / 1000);
+  __timings_flush();
+}
+};     // namespace __impl
+
+// result caching
+// a pass is keyed on (hash of the binary's .text, test case name), so any change to the code under
+// test invalidates it; a test case that drew from the fuzz rng is keyed on the fuzz seed too, and
+// without a fixed seed its pass isn't cached at all. the cache file is a flat array of u64 keys,
+// appended to under O_APPEND so concurrent binaries can share one file
+
+namespace __impl
+{
+#if __SIZEOF_POINTER__ == 8
+using __elf_ehdr = Elf64_Ehdr;
+using __elf_shdr = Elf64_Shdr;
+#else
+using __elf_ehdr = Elf32_Ehdr;
+using __elf_shdr = Elf32_Shdr;
+#endif
+
+inline u64
+__text_hash_compute(void)
+{
+  int fd = ::open("/proc/self/exe", O_RDONLY | O_CLOEXEC);
+  if ( fd < 0 ) return 0;
+  u64 h = 0;
+  __elf_ehdr eh;
+  if ( ::pread(fd, &eh, sizeof(eh), 0) == sizeof(eh) && __builtin_memcmp(eh.e_ident, ELFMAG, SELFMAG) == 0
+       && eh.e_shentsize == sizeof(__elf_shdr) && eh.e_shstrndx < eh.e_shnum ) {
+    __elf_shdr *sh = new __elf_shdr[eh.e_shnum];
+    const size_t shlen = eh.e_shnum * sizeof(__elf_shdr);
+    if ( ::pread(fd, sh, shlen, static_cast<off_t>(eh.e_shoff)) == static_cast<ssize_t>(shlen) ) {
+      const __elf_shdr &strtab = sh[eh.e_shstrndx];
+      for ( u32 i = 0; i < eh.e_shnum && h == 0; ++i ) {
+        char name[8] = {};
+        if ( sh[i].sh_type != SHT_PROGBITS || sh[i].sh_name >= strtab.sh_size ) continue;
+        if ( ::pread(fd, name, sizeof(name) - 1, static_cast<off_t>(strtab.sh_offset + sh[i].sh_name)) <= 0 ) continue;
+        if ( __builtin_strcmp(name, ".text") != 0 ) continue;
+        u8 *text = new u8[sh[i].sh_size];
+        const ssize_t size = static_cast<ssize_t>(sh[i].sh_size);
+        if ( ::pread(fd, text, sh[i].sh_size, static_cast<off_t>(sh[i].sh_offset)) == size )
+          h = __fnv1a(text, sh[i].sh_size);
+        delete[] text;
+      }
+    }
+    delete[] sh;
+  }
+  ::close(fd);
+  return h;
+}
+
+inline u64
+__text_hash(void)
+{
+  static const u64 h = __text_hash_compute();
+  return h;
+}
+
+struct __result_cache {
+  bool loaded = false;
+  u64 *keys = nullptr;
+  size_t size = 0;
+};
+
+inline __result_cache __global_result_cache{};
+
+// seed is 0 for a test case that didn't fuzz
+inline u64
+__cache_key(const char *name, u64 seed)
+{
+  u64 h = __fnv1a(name, __builtin_strlen(name), __text_hash());
+  return seed ? __fnv1a(&seed, sizeof(seed), h) : h;
+}
+
+inline bool
+__cache_usable(void)
+{
+  return __global_cache != nullptr && __text_hash() != 0;
+}
+
+// whether name passed last time, either without fuzzing or fuzzing under the current seed
+inline bool
+__cache_hit(const char *name)
+{
+  if ( !__cache_usable() || __global_cache_force ) return false;
+  __result_cache &c = __global_result_cache;
+  if ( !c.loaded ) {
+    c.loaded = true;
+    size_t len = 0;
+    u8 *buf = __read_file(__global_cache, len);
+    c.size = len / sizeof(u64);
+    c.keys = new u64[c.size ? c.size : 1];
+    if ( buf ) __builtin_memcpy(c.keys, buf, c.size * sizeof(u64));
+    delete[] buf;
+    __sort(c.keys, c.size);
+  }
+  if ( __sorted_contains(c.keys, c.size, __cache_key(name, 0)) ) return true;
+  return __global_fuzz_seed && __sorted_contains(c.keys, c.size, __cache_key(name, __global_fuzz_seed));
+}
+
+// without a fixed seed the fuzzing in a test case differs from run to run, so its pass can't stand
+// for the next one
+inline void
+__cache_store(const char *name, bool fuzzed)
+{
+  if ( !__cache_usable() || (fuzzed && __global_fuzz_seed == 0) ) return;
+  const u64 key = __cache_key(name, fuzzed ? __global_fuzz_seed : 0);
+  int fd = ::open(__global_cache, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+  if ( fd < 0 ) return;
+  if ( ::write(fd, &key, sizeof(key)) != sizeof(key) )
+    __print("\033[34msnowball warning:\033[0m couldn't write result cache.\n\r");
+  ::close(fd);
+}
+};     // namespace __impl
+
+// runs fn as the body of a named test case, if the current shard owns it and it has no cached pass
+// returns whether the test case was run
+template <typename Fn>
+  requires(micron::is_invocable_v<Fn>)
+bool
+test_case(const char *name, Fn &&fn)
+{
+  if ( !__impl::__shard_owns(name) ) return false;
+  if ( __impl::__cache_hit(name) ) {
+    print("cached pass, skipping ", name);
+    return false;
+  }
+  if ( __global_fuzz_seed ) __impl::__fuzz_state = __impl::__fnv1a(name, __builtin_strlen(name), __global_fuzz_seed) | 1;
+  test_case(name);
+  const u64 failures = __atomic_load_n(&__global_failures, __ATOMIC_RELAXED);
+  u64 t0 = __impl::__now_ns();
+  __impl::__global_timed_start = t0;
+  __atomic_store_n(&__impl::__global_timed_case, name, __ATOMIC_RELEASE);
+  __atomic_store_n(&__impl::__fuzz_drawn, false, __ATOMIC_RELAXED);
+  fn();
+  __atomic_store_n(&__impl::__global_timed_case, static_cast<const char *>(nullptr), __ATOMIC_RELEASE);
+  __impl::__timings_record(name, (__impl::__now_ns() - t0) / 1000);
+  if ( __atomic_load_n(&__global_failures, __ATOMIC_RELAXED) == failures )
+    __impl::__cache_store(name, __atomic_load_n(&__impl::__fuzz_drawn, __ATOMIC_RELAXED));
+  end_test_case();
+  return true;
+}
+
+// suite fixtures
+// fixture<T> is state shared by every test case of a binary, e.g. a large dataset. it is declared once
+// at namespace scope and built by the first get(); if several threads get there at once, one builds
+// it and the others wait. after that it is read only. fixtures are torn down at exit, newest first, and
+// only by the process that built them: a child forked after get() inherits the fixture copy-on-write,
+// and the child's exit leaves the parent's copy alone
+
+namespace __impl
+{
+struct __fixture_node {
+  void (*destroy)(__fixture_node *);
+  __fixture_node *next;
+  pid_t owner;
+};
+
+inline __fixture_node *__global_fixtures = nullptr;
+inline u32 __global_fixtures_hooked = 0;
+
+inline void
+__fixture_teardown(void)
+{
+  const pid_t self = ::getpid();
+  // popped before being destroyed, so a destructor may still use a fixture built before its own
+  while ( __fixture_node *n = __atomic_load_n(&__global_fixtures, __ATOMIC_ACQUIRE) ) {
+    if ( !__atomic_compare_exchange_n(&__global_fixtures, &n, n->next, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) )
+      continue;
+    if ( n->owner == self ) n->destroy(n);
+  }
+}
+
+inline void
+__fixture_push(__fixture_node *n)
+{
+  if ( __atomic_exchange_n(&__global_fixtures_hooked, 1, __ATOMIC_ACQ_REL) == 0 ) ::atexit(&__fixture_teardown);
+  n->owner = ::getpid();
+  n->next = __atomic_load_n(&__global_fixtures, __ATOMIC_RELAXED);
+  while ( !__atomic_compare_exchange_n(&__global_fixtures, &n->next, n, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED) ) {
+  }
+}
+};     // namespace __impl
+
+template <typename T> class fixture : __impl::__fixture_node
+{
+  T (*setup)(void);
+  u32 state = 0;     // 0 not built, 1 being built, 2 built
+  alignas(T) unsigned char storage[sizeof(T)]{};
+
+  static void
+  destroy(__impl::__fixture_node *n)
+  {
+    fixture *f = static_cast<fixture *>(n);
+    __builtin_launder(reinterpret_cast<T *>(f->storage))->~T();
+    __atomic_store_n(&f->state, 0, __ATOMIC_RELEASE);
+  }
+
+  [[gnu::noinline]] void
+  build(void)
+  {
+    for ( u32 spins = 0;; ++spins ) {
+      u32 s = 0;
+      if ( __atomic_compare_exchange_n(&state, &s, 1, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) ) break;
+      if ( s == 2 ) return;
+      // setup can take minutes, waiters stop spinning soon
+      if ( spins < 64 )
+        __impl::__cpu_relax();
+      else
+        ::sched_yield();
+    }
+    try {
+      if ( setup != nullptr )
+        ::new (static_cast<void *>(storage)) T(setup());
+      else if constexpr ( requires { T(); } )
+        ::new (static_cast<void *>(storage)) T();
+    } catch ( ... ) {
+      // a waiter takes over and tries again
+      __atomic_store_n(&state, 0, __ATOMIC_RELEASE);
+      throw;
+    }
+    __impl::__fixture_push(this);
+    __atomic_store_n(&state, 2, __ATOMIC_RELEASE);
+  }
+
+public:
+  // constant initialized, so a fixture can be used during the static initialization of other files
+  constexpr fixture(void)
+    requires(requires { T(); })
+      : __impl::__fixture_node{ &destroy, nullptr, 0 }, setup(nullptr)
+  {
+  }
+
+  constexpr explicit fixture(T (*fn)(void)) : __impl::__fixture_node{ &destroy, nullptr, 0 }, setup(fn) {}
+
+  fixture(const fixture &) = delete;
+  fixture &operator=(const fixture &) = delete;
+
+  // builds the fixture if nothing has yet; call it before forking to share one copy with the children
+  const T &
+  get(void)
+  {
+    if ( __atomic_load_n(&state, __ATOMIC_ACQUIRE) != 2 ) [[unlikely]]
+      build();
+    return *__builtin_launder(reinterpret_cast<const T *>(storage));
+  }
+
+  const T &
+  operator*(void)
+  {
+    return get();
+  }
+
+  const T *
+  operator->(void)
+  {
+    return &get();
+  }
+
+  bool
+  built(void) const noexcept
+  {
+    return __atomic_load_n(&state, __ATOMIC_ACQUIRE) == 2;
+  }
+};
+
+// tears down every fixture this process built, newest first; they are built again on their next get()
+inline void
+teardown_fixtures(void)
+{
+  __impl::__fixture_teardown();
+}
+
+// command line options
+//   --shard=i/n          run only the test cases of shard i (0-based) out of n
+//   --timings=path       read/write per test case durations, used to balance shards
+//   --baseline=path      bench baseline file, see bench_baseline()
+//   --update-baseline    overwrite existing bench baseline records
+//   --cache=path         skip test cases with a cached pass, see result_cache()
+//   --force              run everything, but still record passes in the cache
+//   --seed=n             fixed fuzzing seed
+//   --crash-dir=path     where fuzz() writes crashing inputs, see crash_dir()
+//   --stats=path         share fuzzing statistics through this file, see stats_file()
+//   --status=seconds     print a fuzzing status line this often
+//   --corpus=path        a corpus file or directory for fuzz_bytes(), may be repeated
+//   -- path...           more corpus paths, everything after -- is taken as one
+// unrecognized flags and other arguments are left alone
+namespace __impl
+{
+inline const char *
+__flag_value(const char *arg, const char *flag)
+{
+  size_t n = __builtin_strlen(flag);
+  return __builtin_strncmp(arg, flag, n) == 0 ? arg + n : nullptr;
+}
+
+inline u32
+__parse_u32(const char *&p)
+{
+  u32 v = 0;
+  while ( *p >= '0' && *p <= '9' ) v = v * 10 + static_cast<u32>(*p++ - '0');
+  return v;
+}
+};     // namespace __impl
+
+inline void
+init(int argc, char **argv)
+{
+  bool update = false, force = false;
+  const char *baseline = nullptr;
+  const char *cache = nullptr;
+  for ( int i = 1; i < argc; ++i ) {
+    const char *arg = argv[i];
+    if ( const char *v = __impl::__flag_value(arg, "--shard=") ) {
+      u32 index = __impl::__parse_u32(v);
+      if ( *v++ != '/' ) error("malformed --shard, expected --shard=i/n");
+      u32 count = __impl::__parse_u32(v);
+      if ( count == 0 || index >= count ) error("malformed --shard, expected i < n");
+      shard(index, count);
+    } else if ( const char *t = __impl::__flag_value(arg, "--timings=") ) {
+      timings_file(t);
+    } else if ( const char *b = __impl::__flag_value(arg, "--baseline=") ) {
+      baseline = b;
+    } else if ( __builtin_strcmp(arg, "--update-baseline") == 0 ) {
+      update = true;
+    } else if ( const char *c = __impl::__flag_value(arg, "--cache=") ) {
+      cache = c;
+    } else if ( __builtin_strcmp(arg, "--force") == 0 ) {
+      force = true;
+    } else if ( const char *sd = __impl::__flag_value(arg, "--seed=") ) {
+      u64 seed = 0;
+      while ( *sd >= '0' && *sd <= '9' ) seed = seed * 10 + static_cast<u64>(*sd++ - '0');
+      fuzz_seed(seed);
+    } else if ( const char *cd = __impl::__flag_value(arg, "--crash-dir=") ) {
+      crash_dir(cd);
+    } else if ( const char *st = __impl::__flag_value(arg, "--stats=") ) {
+      stats_file(st);
+    } else if ( const char *ss = __impl::__flag_value(arg, "--status=") ) {
+      fuzz_status(__impl::__parse_u32(ss));
+    } else if ( const char *cp = __impl::__flag_value(arg, "--corpus=") ) {
+      __impl::__corpus_path(cp, argc);
+    } else if ( __builtin_strcmp(arg, "--") == 0 ) {
+      while ( ++i < argc ) __impl::__corpus_path(argv[i], argc);
     }
   }
+  if ( baseline != nullptr ) bench_baseline(baseline, update);
+  if ( cache != nullptr ) result_cache(cache, force);
 }
 };     // namespace snowball
 
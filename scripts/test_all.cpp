@@ -0,0 +1,382 @@
+//  Copyright (c) 2024- David Lucius Severus
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  See accompanying file LICENSE.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt
+
+// parallel test driver
+// runs every executable in the given directories (./bin/rigor by default) concurrently, capturing
+// each one's output in memory, and prints a summary sorted by outcome and time
+//
+// usage: snowball_test_all [-jN] [--timeout=seconds] [dir|binary...] [-- args passed to every binary]
+//
+// a binary passes only if it exits with 0; one still running after the timeout (300s by default, 0 for
+// none) is killed along with its process group
+//
+// honors a GNU make jobserver from MAKEFLAGS (--jobserver-auth=R,W or --jobserver-auth=fifo:PATH);
+// without one, -j defaults to the number of online cpus
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace
+{
+// mirrors snowball::__exit()
+constexpr int snowball_failure_code = 6;
+constexpr double default_timeout = 300.0;
+
+struct job {
+  std::string path;
+  std::string output;
+  pid_t pid = -1;
+  int out_fd = -1;
+  int status = 0;
+  bool exited = false;
+  bool has_token = false;
+  bool timed_out = false;
+  char token = '+';
+  double seconds = 0.0;
+  timespec start{};
+
+  // out of line, the implicit ones trip -Winline on the string members
+  job(void);
+  job(job &&) noexcept;
+  job &operator=(job &&) noexcept;
+  ~job(void);
+};
+
+job::job(void) = default;
+job::job(job &&) noexcept = default;
+job &
+job::operator=(job &&) noexcept = default;
+job::~job(void) = default;
+
+struct jobserver {
+  int rfd = -1;
+  int wfd = -1;
+
+  bool
+  open_from_env(void)
+  {
+    const char *flags = getenv("MAKEFLAGS");
+    if ( flags == nullptr ) return false;
+    const char *auth = strstr(flags, "--jobserver-auth=");
+    if ( auth == nullptr ) return false;
+    auth += sizeof("--jobserver-auth=") - 1;
+    std::string value(auth, strcspn(auth, " "));
+    if ( value.rfind("fifo:", 0) == 0 ) {
+      std::string path = value.substr(5);
+      rfd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+      wfd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    } else {
+      int r = -1, w = -1;
+      if ( sscanf(value.c_str(), "%d,%d", &r, &w) != 2 || r < 0 || w < 0 ) return false;
+      // a fresh open gives a private, non-blocking file description, so a token another
+      // process grabbed first never blocks us
+      std::string self = "/proc/self/fd/" + std::to_string(r);
+      rfd = open(self.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+      wfd = fcntl(w, F_DUPFD_CLOEXEC, 0);
+    }
+    if ( rfd < 0 || wfd < 0 ) {
+      if ( rfd >= 0 ) close(rfd);
+      if ( wfd >= 0 ) close(wfd);
+      rfd = wfd = -1;
+      return false;
+    }
+    return true;
+  }
+
+  bool
+  acquire(char &token)
+  {
+    return read(rfd, &token, 1) == 1;
+  }
+
+  void
+  release(char token)
+  {
+    while ( write(wfd, &token, 1) < 0 && errno == EINTR ) {
+    }
+  }
+};
+
+double
+elapsed(const timespec &start)
+{
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<double>(now.tv_sec - start.tv_sec) + static_cast<double>(now.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+bool
+is_executable(const std::string &path)
+{
+  struct stat st;
+  return stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode) && access(path.c_str(), X_OK) == 0;
+}
+
+void
+add(const std::string &path, std::vector<job> &jobs)
+{
+  jobs.emplace_back();
+  jobs.back().path = path;
+}
+
+void
+collect(const std::string &path, std::vector<job> &jobs)
+{
+  struct stat st;
+  if ( stat(path.c_str(), &st) != 0 ) {
+    fprintf(stderr, "snowball_test_all: %s: %s\n", path.c_str(), strerror(errno));
+    return;
+  }
+  if ( !S_ISDIR(st.st_mode) ) {
+    if ( is_executable(path) ) add(path, jobs);
+    return;
+  }
+  DIR *dir = opendir(path.c_str());
+  if ( dir == nullptr ) return;
+  while ( dirent *e = readdir(dir) ) {
+    if ( e->d_name[0] == '.' ) continue;
+    std::string file = path + "/" + e->d_name;
+    if ( is_executable(file) ) add(file, jobs);
+  }
+  closedir(dir);
+}
+
+bool
+spawn(job &j, const std::vector<std::string> &args)
+{
+  int fds[2];
+  if ( pipe2(fds, O_CLOEXEC) != 0 ) return false;
+  clock_gettime(CLOCK_MONOTONIC, &j.start);
+  pid_t pid = fork();
+  if ( pid < 0 ) {
+    close(fds[0]);
+    close(fds[1]);
+    return false;
+  }
+  if ( pid == 0 ) {
+    // its own process group, so a timeout also kills whatever it started
+    setpgid(0, 0);
+    dup2(fds[1], STDOUT_FILENO);
+    dup2(fds[1], STDERR_FILENO);
+    std::vector<char *> argv;
+    argv.push_back(const_cast<char *>(j.path.c_str()));
+    for ( const std::string &a : args ) argv.push_back(const_cast<char *>(a.c_str()));
+    argv.push_back(nullptr);
+    execv(j.path.c_str(), argv.data());
+    _exit(127);
+  }
+  setpgid(pid, pid);
+  close(fds[1]);
+  fcntl(fds[0], F_SETFL, O_NONBLOCK);
+  j.pid = pid;
+  j.out_fd = fds[0];
+  return true;
+}
+
+// drains whatever output is ready; returns false once the pipe is closed
+bool
+drain(job &j)
+{
+  char buf[65536];
+  for ( ;; ) {
+    ssize_t r = read(j.out_fd, buf, sizeof(buf));
+    if ( r > 0 ) {
+      j.output.append(buf, static_cast<size_t>(r));
+      if ( static_cast<size_t>(r) < sizeof(buf) ) return true;
+      continue;
+    }
+    if ( r < 0 && errno == EINTR ) continue;
+    return r < 0 && errno == EAGAIN;
+  }
+}
+
+std::string
+describe(const job &j, bool &passed)
+{
+  passed = false;
+  if ( j.timed_out ) return "TIMEOUT (killed after " + std::to_string(static_cast<long>(j.seconds)) + "s)";
+  if ( WIFSIGNALED(j.status) ) {
+    int sig = WTERMSIG(j.status);
+    return std::string("CRASH (") + (sigabbrev_np(sig) ? "SIG" + std::string(sigabbrev_np(sig)) : std::to_string(sig))
+           + ")";
+  }
+  int ret = WEXITSTATUS(j.status);
+  if ( ret == 0 ) {
+    passed = true;
+    return "PASS";
+  }
+  if ( ret == snowball_failure_code ) return "FAIL (snowball require failure)";
+  if ( ret == 127 ) return "ERROR (couldn't execute)";
+  return "FAIL (returned " + std::to_string(ret) + ")";
+}
+};     // namespace
+
+int
+main(int argc, char **argv)
+{
+  long limit = 0;
+  double timeout = default_timeout;
+  std::vector<std::string> paths;
+  std::vector<std::string> forward;
+  for ( int i = 1; i < argc; ++i ) {
+    std::string a = argv[i];
+    if ( a == "--" ) {
+      for ( ++i; i < argc; ++i ) forward.emplace_back(argv[i]);
+      break;
+    }
+    if ( a.rfind("-j", 0) == 0 ) {
+      std::string v = a.substr(2);
+      // -j alone takes the next argument only when it's a count, so "-j dir" still runs dir
+      if ( v.empty() && i + 1 < argc && argv[i + 1][0] >= '0' && argv[i + 1][0] <= '9' ) v = argv[++i];
+      limit = strtol(v.c_str(), nullptr, 10);
+      continue;
+    }
+    if ( a.rfind("--timeout=", 0) == 0 ) {
+      timeout = strtod(a.c_str() + 10, nullptr);
+      continue;
+    }
+    paths.push_back(a);
+  }
+  if ( paths.empty() ) paths.emplace_back("./bin/rigor");
+
+  std::vector<job> jobs;
+  for ( const std::string &p : paths ) collect(p, jobs);
+  std::sort(jobs.begin(), jobs.end(), [](const job &a, const job &b) { return a.path < b.path; });
+  if ( jobs.empty() ) {
+    fprintf(stderr, "snowball_test_all: no test binaries found\n");
+    return 1;
+  }
+
+  jobserver js;
+  const bool use_js = js.open_from_env();
+  if ( limit <= 0 ) limit = use_js ? static_cast<long>(jobs.size()) : sysconf(_SC_NPROCESSORS_ONLN);
+  if ( limit <= 0 ) limit = 1;
+  signal(SIGPIPE, SIG_IGN);
+
+  timespec total_start;
+  clock_gettime(CLOCK_MONOTONIC, &total_start);
+  size_t next = 0, running = 0, done = 0;
+  bool implicit_free = true;     // every jobserver client owns one implicit token
+  std::vector<pollfd> pfds;
+  std::vector<size_t> owners;
+  while ( done < jobs.size() ) {
+    // start as many jobs as the limit and the jobserver allow
+    while ( next < jobs.size() && static_cast<long>(running) < limit ) {
+      job &j = jobs[next];
+      if ( use_js ) {
+        if ( implicit_free )
+          implicit_free = false;
+        else if ( js.acquire(j.token) )
+          j.has_token = true;
+        else
+          break;
+      }
+      if ( !spawn(j, forward) ) {
+        j.exited = true;
+        j.status = 127 << 8;
+        if ( j.has_token )
+          js.release(j.token);
+        else if ( use_js )
+          implicit_free = true;
+        ++done;
+      } else {
+        ++running;
+      }
+      ++next;
+    }
+
+    pfds.clear();
+    owners.clear();
+    for ( size_t i = 0; i < next; ++i )
+      if ( jobs[i].out_fd >= 0 ) {
+        pfds.push_back({ jobs[i].out_fd, POLLIN, 0 });
+        owners.push_back(i);
+      }
+    const bool want_token = use_js && next < jobs.size() && static_cast<long>(running) < limit;
+    if ( want_token ) pfds.push_back({ js.rfd, POLLIN, 0 });
+    if ( pfds.empty() ) continue;
+    // wake up in time for the earliest deadline
+    int wait_ms = -1;
+    if ( timeout > 0 )
+      for ( size_t i : owners ) {
+        const double left = timeout - elapsed(jobs[i].start);
+        const int ms = left > 0 ? static_cast<int>(left * 1000) + 1 : 0;
+        if ( wait_ms < 0 || ms < wait_ms ) wait_ms = ms;
+      }
+    if ( poll(pfds.data(), pfds.size(), wait_ms) < 0 && errno != EINTR ) break;
+    if ( timeout > 0 )
+      for ( size_t i : owners ) {
+        job &j = jobs[i];
+        if ( j.timed_out || elapsed(j.start) < timeout ) continue;
+        // the pipe closes once the whole group is gone, and the job is reaped below as usual
+        j.timed_out = true;
+        kill(-j.pid, SIGKILL);
+      }
+
+    for ( size_t k = 0; k < owners.size(); ++k ) {
+      if ( !(pfds[k].revents & (POLLIN | POLLHUP | POLLERR)) ) continue;
+      job &j = jobs[owners[k]];
+      if ( drain(j) ) continue;
+      // output closed, the binary is done
+      close(j.out_fd);
+      j.out_fd = -1;
+      while ( waitpid(j.pid, &j.status, 0) < 0 && errno == EINTR ) {
+      }
+      j.seconds = elapsed(j.start);
+      j.exited = true;
+      if ( j.has_token )
+        js.release(j.token);
+      else if ( use_js )
+        implicit_free = true;
+      --running;
+      ++done;
+    }
+  }
+
+  std::vector<size_t> order(jobs.size());
+  std::vector<std::string> verdicts(jobs.size());
+  std::vector<char> passed(jobs.size());
+  for ( size_t i = 0; i < jobs.size(); ++i ) {
+    bool ok = false;
+    order[i] = i;
+    verdicts[i] = describe(jobs[i], ok);
+    passed[i] = ok;
+  }
+  // failures first, then slowest first
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    if ( passed[a] != passed[b] ) return !passed[a];
+    return jobs[a].seconds > jobs[b].seconds;
+  });
+
+  size_t failures = 0;
+  for ( size_t i : order )
+    if ( !passed[i] ) {
+      ++failures;
+      printf("\033[1;31m==== %s ====\033[0m\n", jobs[i].path.c_str());
+      fwrite(jobs[i].output.data(), 1, jobs[i].output.size(), stdout);
+      if ( !jobs[i].output.empty() && jobs[i].output.back() != '\n' ) putchar('\n');
+    }
+  for ( size_t i : order ) {
+    const char *slash = strrchr(jobs[i].path.c_str(), '/');
+    printf("%8.3fs  %s: %s\n", jobs[i].seconds, slash ? slash + 1 : jobs[i].path.c_str(), verdicts[i].c_str());
+  }
+  printf("%zu/%zu passed in %.3fs (-j%ld)\n", jobs.size() - failures, jobs.size(), elapsed(total_start), limit);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,73 @@
+//  Copyright (c) 2024- David Lucius Severus
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  See accompanying file LICENSE.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt
+#include "expect.hpp"
+
+sb::task<int>
+answer_later(u64 ms)
+{
+  co_await sb::delay(ms);
+  co_return 42;
+}
+
+int
+main(void)
+{
+  sb::test_case("Async cases sleep concurrently");
+  u32 finished = 0;
+  for ( u32 i = 0; i < 3; ++i )
+    sb::async_test("sleeper", [&]() -> sb::task<> {
+      const int v = co_await answer_later(50);
+      co_await sb::co_check(v == 42);
+      co_await sb::yield();
+      ++finished;
+    });
+  const u64 t0 = sb::__impl::__now_ns();
+  sb::require(sb::async_run(), 0u);
+  sb::require(finished, 3u);
+  sb::require((sb::__impl::__now_ns() - t0) / 1000000 < 140);
+
+  sb::test_case("Async cases waiting on a pipe");
+  int fds[2];
+  sb::require(pipe(fds) == 0);
+  char got = 0;
+  sb::async_test("reader", [&]() -> sb::task<> {
+    co_await sb::readable(fds[0]);
+    co_await sb::co_require(read(fds[0], &got, 1) == 1);
+  });
+  sb::async_test("writer", [&]() -> sb::task<> {
+    co_await sb::delay(10);
+    co_await sb::writable(fds[1]);
+    co_await sb::co_require(write(fds[1], "x", 1) == 1);
+  });
+  sb::require(sb::async_run(), 0u);
+  sb::require(got == 'x');
+  close(fds[0]);
+  close(fds[1]);
+
+  sb::test_case("Failing async cases");
+  outcome o = isolated([]() {
+    sb::async_test("checks", []() -> sb::task<> { co_await sb::co_check(false); });
+    sb::require(sb::async_run(), 1u);
+  });
+  sb::require(o.code, checks_failed_code);
+  sb::require(o.says("co_check() failure"));
+  o = isolated([]() {
+    sb::async_test("requires", []() -> sb::task<> { co_await sb::co_require(false); });
+    sb::async_run();
+  });
+  sb::require(o.code, required_code);
+  sb::require(o.says("co_require() failure"));
+
+  sb::test_case("Awaiting outside of async_run()");
+  o = isolated([]() {
+    auto t = answer_later(1);
+    t.__release().resume();
+  });
+  sb::require(o.code, required_code);
+  sb::require(o.says("delay() failure:\033[0m awaited outside of async_run()"));
+  sb::end_test_case();
+  return 0;
+}
@@ -0,0 +1,146 @@
+//  Copyright (c) 2024- David Lucius Severus
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  See accompanying file LICENSE.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt
+#include "expect.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <stdlib.h>
+
+bool
+close_to(double a, double b)
+{
+  return std::fabs(a - b) < 1e-9 * (std::fabs(b) > 1.0 ? std::fabs(b) : 1.0);
+}
+
+// the Hodges-Lehmann estimate from every pairwise difference, as __mann_whitney() used to build it
+double
+brute_speedup(const std::vector<double> &base, const std::vector<double> &cur)
+{
+  std::vector<double> diff;
+  for ( double x : base )
+    for ( double y : cur ) diff.push_back(std::log(x) - std::log(y));
+  std::sort(diff.begin(), diff.end());
+  const size_t m = diff.size();
+  return std::exp(m % 2 ? diff[m / 2] : (diff[m / 2 - 1] + diff[m / 2]) / 2.0);
+}
+
+std::vector<double>
+samples(u64 seed, size_t n, double scale)
+{
+  std::vector<double> v(n);
+  for ( double &x : v ) x = scale * (1.0 + static_cast<double>(sb::__impl::__xorshift64(seed) % 1000) / 100.0);
+  return v;
+}
+
+std::vector<u8>
+read_all(const std::string &path)
+{
+  size_t len = 0;
+  u8 *buf = sb::__impl::__read_file(path.c_str(), len);
+  std::vector<u8> v(buf, buf + len);
+  delete[] buf;
+  return v;
+}
+
+u64
+key_of(const char *name)
+{
+  return sb::__impl::__fnv1a(name, __builtin_strlen(name), sb::__impl::__machine_fingerprint());
+}
+
+int
+main(void)
+{
+  using namespace sb::__impl;
+
+  sb::test_case("Mann-Whitney z against known values");
+  const double lo5[5] = { 1, 2, 3, 4, 5 }, hi5[5] = { 6, 7, 8, 9, 10 };
+  // U = 25 of a mean 12.5, variance 25 * 11 / 12, continuity corrected
+  sb::require(close_to(__mann_whitney(lo5, 5, hi5, 5).z, 12.0 / std::sqrt(275.0 / 12.0)));
+  sb::require(close_to(__mann_whitney(hi5, 5, lo5, 5).z, -12.0 / std::sqrt(275.0 / 12.0)));
+  // ties of 2, 3 and 3: U = 15 of a mean 8, variance 16 / 12 * (9 - 54 / 56)
+  const double tied_base[4] = { 1, 1, 2, 2 }, tied_cur[4] = { 2, 3, 3, 3 };
+  sb::require(close_to(__mann_whitney(tied_base, 4, tied_cur, 4).z, 6.5 / std::sqrt(16.0 / 12.0 * (9.0 - 54.0 / 56.0))));
+  const double same[3] = { 4, 4, 4 };
+  sb::require(close_to(__mann_whitney(same, 3, same, 3).z, 0.0));
+
+  sb::test_case("Hodges-Lehmann speedup and interval");
+  const double twice[3] = { 2, 2, 2 }, once[3] = { 1, 1, 1 };
+  const __bench_stats halved = __mann_whitney(twice, 3, once, 3);
+  sb::require(close_to(halved.speedup, 2.0) && close_to(halved.lo, 2.0) && close_to(halved.hi, 2.0));
+  const u32 sizes[][2] = { { 37, 41 }, { 50, 50 }, { 1, 9 }, { 64, 2 } };
+  for ( const auto &sz : sizes ) {
+    const std::vector<double> base = samples(sz[0] * 7 + 1, sz[0], 100.0), cur = samples(sz[1] * 13 + 5, sz[1], 120.0);
+    const __bench_stats st = __mann_whitney(base.data(), sz[0], cur.data(), sz[1]);
+    sb::require(close_to(st.speedup, brute_speedup(base, cur)));
+    sb::require(st.lo <= st.speedup && st.speedup <= st.hi);
+  }
+  // 10k samples each used to take 800 MB of pairwise differences
+  const std::vector<double> big_base = samples(3, 10000, 100.0), big_cur = samples(4, 10000, 100.0);
+  const __bench_stats big = __mann_whitney(big_base.data(), 10000, big_cur.data(), 10000);
+  sb::require(big.speedup > 0.9 && big.speedup < 1.1);
+
+  char dir[] = "/tmp/snowball_bench_XXXXXX";
+  sb::require(mkdtemp(dir) != nullptr);
+  const std::string path = std::string(dir) + "/baseline.bin";
+
+  sb::test_case("Baseline records round-trip");
+  const double first[3] = { 1.5, 2.5, 3.5 }, second[2] = { 7, 8 }, replaced[4] = { 9, 10, 11, 12 };
+  __bench_store(path.c_str(), nullptr, 0, 0, 11, first, 3);
+  std::vector<u8> file = read_all(path);
+  __bench_record rec{};
+  size_t off = __bench_find(file.data(), file.size(), 11, rec);
+  sb::require(off != 0u);
+  sb::require(rec.count, 3u);
+  sb::require(__builtin_memcmp(file.data() + off + sizeof(rec), first, sizeof(first)) == 0);
+  sb::require(__bench_find(file.data(), file.size(), 22, rec), 0u);
+  __bench_store(path.c_str(), file.data(), file.size(), 0, 22, second, 2);
+  file = read_all(path);
+  off = __bench_find(file.data(), file.size(), 11, rec);
+  __bench_store(path.c_str(), file.data(), file.size(), off, 11, replaced, 4);
+  file = read_all(path);
+  sb::require(file.size(), 8 + 2 * sizeof(__bench_record) + sizeof(second) + sizeof(replaced));
+  off = __bench_find(file.data(), file.size(), 11, rec);
+  sb::require(rec.count, 4u);
+  sb::require(__builtin_memcmp(file.data() + off + sizeof(rec), replaced, sizeof(replaced)) == 0);
+  off = __bench_find(file.data(), file.size(), 22, rec);
+  sb::require(rec.count, 2u);
+  sb::require(__builtin_memcmp(file.data() + off + sizeof(rec), second, sizeof(second)) == 0);
+  file[0] ^= 1;
+  sb::require(__bench_find(file.data(), file.size(), 22, rec), 0u);
+  sb::require(__bench_find(file.data(), file.size() - 1, 22, rec), 0u);
+  ::unlink(path.c_str());
+
+  sb::test_case("Baselines are keyed on the name and the machine");
+  sb::bench_baseline(path.c_str());
+  const std::vector<double> usual = samples(9, 64, 1000.0);
+  __bench_report("kernel", usual.data(), 64);
+  file = read_all(path);
+  sb::require(__bench_find(file.data(), file.size(), key_of("kernel"), rec) != 0u);
+  sb::require(__bench_find(file.data(), file.size(), __fnv1a("kernel", 6), rec), 0u);
+  sb::require(__bench_find(file.data(), file.size(), key_of("other"), rec), 0u);
+
+  sb::test_case("A significant regression fails the run");
+  const std::vector<double> noise = samples(10, 64, 1000.0), slower = samples(11, 64, 1500.0);
+  outcome o = isolated([&]() { __bench_report("kernel", noise.data(), 64); });
+  sb::require(o.code, passed_code);
+  sb::require(o.says("vs baseline"));
+  o = isolated([&]() { __bench_report("kernel", slower.data(), 64); });
+  sb::require(o.code, required_code);
+  sb::require(o.says("bench() failure:\033[0m statistically significant regression in kernel."));
+  o = isolated([&]() { __bench_report("fresh", slower.data(), 64); });
+  sb::require(o.code, passed_code);
+  sb::require(o.says("vs baseline") == false);
+  sb::bench_baseline(nullptr);
+  ::unlink(path.c_str());
+  ::rmdir(dir);
+
+  sb::end_test_case();
+  return 0;
+}
@@ -0,0 +1,59 @@
+//  Copyright (c) 2024- David Lucius Severus
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  See accompanying file LICENSE.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt
+#include "../include/snowball.hpp"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+static const char *cache_path = "snowball_cache_test.bin";
+
+// runs the test case in a fresh child, as the next run of the binary would; returns whether it ran
+bool
+run_once(const char *name, bool fuzzes = false)
+{
+  pid_t pid = fork();
+  if ( pid == 0 ) {
+    if ( fuzzes ) _exit(sb::test_case(name, []() { sb::fuzz([](u32) {}, 10); }) ? 1 : 0);
+    _exit(sb::test_case(name, []() {}) ? 1 : 0);
+  }
+  int status = 0;
+  waitpid(pid, &status, 0);
+  return WIFEXITED(status) && WEXITSTATUS(status) == 1;
+}
+
+int
+main(void)
+{
+  unlink(cache_path);
+  sb::test_case("Fuzzing passes are cached under a fixed seed");
+  sb::fuzz_seed(42);
+  sb::result_cache(cache_path);
+  sb::require(run_once("seeded", true));
+  sb::require(run_once("seeded", true) == false);
+  sb::test_case("A different seed is a different key");
+  sb::fuzz_seed(43);
+  sb::require(run_once("seeded", true));
+  sb::test_case("Forced runs ignore cached passes");
+  sb::fuzz_seed(42);
+  sb::result_cache(cache_path, true);
+  sb::require(run_once("seeded", true));
+  sb::result_cache(cache_path, false);
+  sb::require(run_once("seeded", true) == false);
+  sb::test_case("Fuzzing passes aren't cached without a seed");
+  sb::fuzz_seed(0);
+  sb::require(run_once("unseeded", true));
+  sb::require(run_once("unseeded", true));
+  sb::test_case("Passes that don't fuzz are cached without a seed");
+  sb::require(run_once("plain"));
+  sb::require(run_once("plain") == false);
+  sb::test_case("Passes that don't fuzz ignore the seed");
+  sb::fuzz_seed(7);
+  sb::require(run_once("plain") == false);
+  sb::fuzz_seed(0);
+  sb::end_test_case();
+  unlink(cache_path);
+  return 0;
+}
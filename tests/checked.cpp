@@ -0,0 +1,91 @@
+//  Copyright (c) 2024- David Lucius Severus
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  See accompanying file LICENSE.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt
+// fuzz_checked() without the __cxa_throw hook, which tests/fuzz.cpp covers
+#define SNOWBALL_NO_THROW_HOOK
+#include "expect.hpp"
+
+#include <dirent.h>
+#include <stdexcept>
+#include <stdlib.h>
+
+[[gnu::noinline]] void
+rejects_odd(u32 x)
+{
+  if ( x & 1 ) throw std::invalid_argument("odd");
+}
+
+[[gnu::noinline]] void
+rejects_large(u32 x)
+{
+  if ( x > (1u << 24) ) throw std::invalid_argument("large");
+}
+
+[[gnu::noinline]] void
+rejects_zero(u32 x)
+{
+  if ( x == 0 ) throw std::domain_error("zero");
+}
+
+// two throw sites of one exception type
+u32
+validates(u32 x)
+{
+  rejects_large(x);
+  rejects_odd(x);
+  return x;
+}
+
+u32
+validates_all(u32 x)
+{
+  rejects_zero(x % 16);
+  return validates(x);
+}
+
+u32
+failures_in(const char *dir)
+{
+  u32 n = 0;
+  if ( DIR *d = opendir(dir) ) {
+    while ( dirent *e = readdir(d) ) n += std::string(e->d_name).rfind("failure-", 0) == 0;
+    closedir(d);
+  }
+  return n;
+}
+
+int
+main(void)
+{
+  char dir[] = "/tmp/snowball_checked_XXXXXX";
+  sb::require(mkdtemp(dir) != nullptr);
+  sb::crash_dir(dir);
+
+  sb::test_case("Without the throw hook, throw sites of one type share a bucket");
+  outcome o = isolated([]() { sb::fuzz_checked(validates, 5000); });
+  sb::require(o.code, required_code);
+  sb::require(o.says("1 distinct failure(s) in 5000 inputs"));
+  sb::require(o.says("threw std::invalid_argument: "));
+  sb::require(failures_in(dir), 1u);
+  sb::test_case("Without the throw hook, exception types still get buckets of their own");
+  o = isolated([]() { sb::fuzz_checked(validates_all, 5000); });
+  sb::require(o.code, required_code);
+  sb::require(o.says("2 distinct failure(s) in 5000 inputs"));
+  sb::require(o.says("threw std::domain_error: zero"));
+  sb::require(o.says("threw std::invalid_argument: "));
+  sb::test_case("Without the throw hook, oracle rejections are a bucket of their own");
+  o = isolated([]() { sb::fuzz_checked(validates, 5000, [](u32 r) { return r % 4 != 0; }); });
+  sb::require(o.says("2 distinct failure(s) in 5000 inputs"));
+  sb::require(o.says("oracle rejected the result"));
+  sb::end_test_case();
+
+  if ( DIR *d = opendir(dir) ) {
+    while ( dirent *e = readdir(d) )
+      if ( e->d_name[0] != '.' ) unlink((std::string(dir) + "/" + e->d_name).c_str());
+    closedir(d);
+  }
+  rmdir(dir);
+  return 0;
+}
@@ -0,0 +1,100 @@
+//  Copyright (c) 2024- David Lucius Severus
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  See accompanying file LICENSE.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt
+#include "expect.hpp"
+
+#include <vector>
+
+// whether every t-tuple of values, over every t of the k columns, appears in some row
+bool
+covers(const u32 *rows, u64 count, const std::vector<u32> &sizes, u32 t)
+{
+  const u32 k = static_cast<u32>(sizes.size());
+  for ( u32 mask = 0; mask < (1u << k); ++mask ) {
+    if ( static_cast<u32>(__builtin_popcount(mask)) != t ) continue;
+    u64 tuples = 1;
+    for ( u32 c = 0; c < k; ++c )
+      if ( mask >> c & 1 ) tuples *= sizes[c];
+    std::vector<bool> seen(tuples);
+    for ( u64 r = 0; r < count; ++r ) {
+      u64 x = 0;
+      for ( u32 c = 0; c < k; ++c ) {
+        if ( !(mask >> c & 1) ) continue;
+        if ( rows[r * k + c] >= sizes[c] ) return false;
+        x = x * sizes[c] + rows[r * k + c];
+      }
+      seen[x] = true;
+    }
+    for ( u64 x = 0; x < tuples; ++x )
+      if ( !seen[x] ) return false;
+  }
+  return true;
+}
+
+int
+reference(int a, int b, int c)
+{
+  return a * b + c;
+}
+
+// wrong only where a == 2 and c == 1, an interaction of two parameters
+int
+pairwise_bug(int a, int b, int c)
+{
+  return a * b + c + (a == 2 && c == 1);
+}
+
+int
+main(void)
+{
+  sb::test_case("Covering arrays cover every t-tuple");
+  const struct {
+    u32 t;
+    std::vector<u32> sizes;
+  } arrays[] = {
+    { 2, { 3, 3, 3 } },          { 2, { 5, 4, 3, 2, 2 } },       { 2, { 2, 2, 2, 2, 2, 2, 2, 2 } },
+    { 3, { 2, 3, 2, 4 } },       { 3, { 3, 3, 3, 3, 3, 3 } },    { 4, { 2, 2, 3, 2, 2 } },
+    { 1, { 3, 1, 2, 5 } },       { 2, { 1, 4, 1 } },             { 5, { 2, 3, 2, 2, 3, 2 } },
+    { 2, { 10, 10, 2, 2, 2, 2 } },
+  };
+  for ( const auto &a : arrays ) {
+    const u32 k = static_cast<u32>(a.sizes.size());
+    u64 product = 1;
+    for ( u32 s : a.sizes ) product *= s;
+    u64 count = 0;
+    u32 *rows = sb::__impl::__covering_rows(a.sizes.data(), k, a.t, count);
+    sb::require(covers(rows, count, a.sizes, a.t));
+    sb::require(count <= product);
+    delete[] rows;
+  }
+
+  const int as[4] = { 0, 1, 2, 3 };
+  const int bs[3] = { -1, 0, 5 };
+  const int cs[2] = { 0, 1 };
+  sb::test_case("Products and covering arrays that pass");
+  sb::require_product(reference, reference, as, bs, cs);
+  sb::require_product(reference, [](int a, int b, int c, int r) { return r - c == a * b; }, as, bs, cs);
+  sb::require_covering(reference, reference, as, bs, cs);
+  sb::require_covering<3>(reference, reference, as, bs, cs);
+
+  sb::test_case("Products report the failing combinations");
+  outcome o = isolated([&]() { sb::require_product(pairwise_bug, reference, as, bs, cs); });
+  sb::require(o.code, required_code);
+  sb::require(o.says("require_product() failure:\033[0m 3 of 24 combinations failed:"));
+  sb::require(o.in_order("(2, -1, 1): got 0, expected -1", "(2, 0, 1): got 2, expected 1"));
+  sb::require(o.in_order("(2, 0, 1): got 2, expected 1", "(2, 5, 1): got 12, expected 11"));
+  o = isolated([&]() { sb::check_product(pairwise_bug, reference, as, bs, cs); });
+  sb::require(o.code, checks_failed_code);
+  sb::test_case("Pairwise covering arrays find pairwise bugs");
+  o = isolated([&]() { sb::require_covering(pairwise_bug, reference, as, bs, cs); });
+  sb::require(o.code, required_code);
+  sb::require(o.says("require_covering() failure:"));
+  sb::require(o.says(" of 24 combinations failed") == false);
+  o = isolated([&]() { sb::check_covering<2>(pairwise_bug, reference, as, bs, cs); });
+  sb::require(o.code, checks_failed_code);
+
+  sb::end_test_case();
+  return 0;
+}
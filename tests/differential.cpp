@@ -0,0 +1,41 @@
+//  Copyright (c) 2024- David Lucius Severus
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  See accompanying file LICENSE.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt
+#include "expect.hpp"
+
+u32
+popcount_ref(u32 x)
+{
+  u32 n = 0;
+  for ( ; x; x >>= 1 ) n += x & 1;
+  return n;
+}
+
+u32
+popcount_fast(u32 x)
+{
+  return static_cast<u32>(__builtin_popcount(x));
+}
+
+// wrong whenever the top bit is set
+u32
+popcount_broken(u32 x)
+{
+  return static_cast<u32>(__builtin_popcount(x & 0x7fffffffu));
+}
+
+int
+main(void)
+{
+  sb::test_case("Differential testing of equivalent implementations");
+  sb::differential(popcount_ref, popcount_fast, 100000);
+  sb::test_case("Differential testing finds a mismatch");
+  outcome o = isolated([]() { sb::differential(popcount_ref, popcount_broken, 100000); });
+  sb::require(o.code, required_code);
+  sb::require(o.says("differential() failure"));
+  sb::require(o.says("inputs differ, first at input"));
+  sb::end_test_case();
+  return 0;
+}
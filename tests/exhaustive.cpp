@@ -0,0 +1,64 @@
+//  Copyright (c) 2024- David Lucius Severus
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  See accompanying file LICENSE.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt
+#include "expect.hpp"
+
+u32
+bits_ref(u16 x)
+{
+  u32 n = 0;
+  for ( ; x; x = static_cast<u16>(x >> 1) ) n += x & 1;
+  return n;
+}
+
+u32
+bits_fast(u16 x)
+{
+  return static_cast<u32>(__builtin_popcount(x));
+}
+
+// wrong on exactly one input
+u32
+bits_planted(u16 x)
+{
+  return static_cast<u32>(__builtin_popcount(x)) + (x == 0x1234);
+}
+
+// wrong on every multiple of 1000, 0 included
+u32
+bits_periodic(u16 x)
+{
+  return static_cast<u32>(__builtin_popcount(x)) + (x % 1000 == 0);
+}
+
+int
+main(void)
+{
+  sb::test_case("exhaustive() passes a function that matches its reference");
+  sb::exhaustive<u16>(bits_fast, bits_ref);
+  sb::exhaustive<i8>([](i8 x) { return x / 2; }, [](i8 x, int half) { return half * 2 + x % 2 == x; });
+  sb::exhaustive<bool>([](bool b) { return !b; }, [](bool b) { return b ? false : true; });
+
+  sb::test_case("exhaustive<u16>() finds a planted mismatch");
+  outcome o = isolated([]() { sb::exhaustive<u16>(bits_planted, bits_ref); });
+  sb::require(o.code, required_code);
+  sb::require(o.says("1 of 65536 inputs mismatched:"));
+  sb::require(o.says("input 0x1234 (4660): got 6, expected 5"));
+
+  sb::test_case("exhaustive() reports the first mismatches in order");
+  o = isolated([]() { sb::exhaustive<u16>(bits_periodic, bits_ref); });
+  sb::require(o.code, required_code);
+  sb::require(o.says("66 of 65536 inputs mismatched, the first ones:"));
+  sb::require(o.in_order("input 0x0000 ", "input 0x03e8 "));
+  sb::require(o.in_order("input 0x03e8 ", "input 0x07d0 "));
+  sb::require(o.says("input 0xfde8") == false);
+  o = isolated([]() { sb::exhaustive<u16>(bits_fast, [](u16 x, u32 n) { return x < 0x8000 || n > 1; }); });
+  sb::require(o.code, required_code);
+  sb::require(o.says("1 of 65536 inputs mismatched:"));
+  sb::require(o.says("input 0x8000 (32768): got 1\n"));
+
+  sb::end_test_case();
+  return 0;
+}
@@ -0,0 +1,72 @@
+//  Copyright (c) 2024- David Lucius Severus
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  See accompanying file LICENSE.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt
+#pragma once
+
+// helpers for testing snowball's own failure paths, which report and then end the process
+#include "../include/snowball.hpp"
+
+#include <string>
+
+#include <errno.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// exit codes of an isolated run
+constexpr int passed_code = 0;
+constexpr int checks_failed_code = 5;     // fn returned, but a check() failed
+constexpr int required_code = 6;          // snowball::__exit()
+
+struct outcome {
+  int code = -1;
+  std::string output;
+
+  bool
+  says(const char *text) const
+  {
+    return output.find(text) != std::string::npos;
+  }
+
+  // whether a appears before b in the output
+  bool
+  in_order(const char *a, const char *b) const
+  {
+    const size_t i = output.find(a);
+    return i != std::string::npos && output.find(b, i + 1) != std::string::npos;
+  }
+};
+
+// runs fn in a forked child, capturing its stdout and stderr and how it exited
+template <typename Fn>
+outcome
+isolated(Fn &&fn)
+{
+  outcome o;
+  int fds[2];
+  if ( pipe(fds) != 0 ) return o;
+  pid_t pid = fork();
+  if ( pid == 0 ) {
+    close(fds[0]);
+    dup2(fds[1], STDOUT_FILENO);
+    dup2(fds[1], STDERR_FILENO);
+    const u64 failures = sb::__global_failures;
+    fn();
+    _exit(sb::__global_failures == failures ? passed_code : checks_failed_code);
+  }
+  close(fds[1]);
+  char buf[4096];
+  for ( ;; ) {
+    const ssize_t r = read(fds[0], buf, sizeof(buf));
+    if ( r > 0 )
+      o.output.append(buf, static_cast<size_t>(r));
+    else if ( r == 0 || errno != EINTR )
+      break;
+  }
+  close(fds[0]);
+  int status = 0;
+  waitpid(pid, &status, 0);
+  o.code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+  return o;
+}
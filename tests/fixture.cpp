@@ -0,0 +1,110 @@
+//  Copyright (c) 2024- David Lucius Severus
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  See accompanying file LICENSE.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt
+#include "expect.hpp"
+
+#include <stdlib.h>
+
+u32 builds[3] = {};
+char torn_down[16] = {};
+u32 torn = 0;
+int trace_fd = -1;     // where teardowns are traced, only set in isolated() children
+
+struct resource {
+  u32 which;
+  u32 payload[256];
+
+  explicit resource(u32 w) : which(w), payload{}
+  {
+    ++builds[w];
+    for ( u32 &p : payload ) p = w;
+  }
+  resource(const resource &) = default;
+  ~resource()
+  {
+    torn_down[torn++ % sizeof(torn_down)] = static_cast<char>('a' + which);
+    if ( trace_fd < 0 ) return;
+    // unbuffered, so a forked child's teardown shows up in its output
+    const char line[] = { 't', 'o', 'r', 'n', ' ', static_cast<char>('a' + which), '\n' };
+    static_cast<void>(::write(trace_fd, line, sizeof(line)));
+  }
+};
+
+resource
+make_a(void)
+{
+  return resource(0);
+}
+
+resource
+make_b(void)
+{
+  return resource(1);
+}
+
+// slow enough that every thread of a stress() round arrives while it is being built
+resource
+make_slow(void)
+{
+  ::usleep(20000);
+  return resource(2);
+}
+
+sb::fixture<resource> first(make_a);
+sb::fixture<resource> second(make_b);
+sb::fixture<resource> slow(make_slow);
+
+int
+main(void)
+{
+  sb::test_case("Fixtures are built on their first get()");
+  sb::require(first.built() == false);
+  sb::require(builds[0], 0u);
+  sb::require(first->which, 0u);
+  sb::require(first.built());
+  sb::require(builds[0], 1u);
+  sb::require((*first).payload[255], 0u);
+  sb::require(&first.get() == &*first);
+  sb::require(builds[0], 1u);
+
+  sb::test_case("Concurrent get() builds once");
+  const resource *seen[8] = {};
+  sb::stress(8, 1, [&](u32 t) { seen[t] = &slow.get(); });
+  sb::require(builds[2], 1u);
+  for ( const resource *r : seen ) sb::require(r == &slow.get());
+
+  sb::test_case("A forked child leaves its parent's fixtures alone");
+  outcome o = isolated([]() {
+    trace_fd = STDOUT_FILENO;
+    sb::require(first->which, 0u);
+    ::exit(passed_code);
+  });
+  sb::require(o.code, passed_code);
+  sb::require(o.says("torn") == false);
+  o = isolated([]() {
+    trace_fd = STDOUT_FILENO;
+    sb::require(second->which, 1u);
+    ::exit(passed_code);
+  });
+  sb::require(o.code, passed_code);
+  sb::require(o.says("torn b\n"));
+  sb::require(o.says("torn a") == false);
+  sb::require(second.built() == false);
+
+  sb::test_case("Teardown goes newest first, and get() builds again");
+  sb::require(second->which, 1u);
+  sb::teardown_fixtures();
+  sb::require(torn, 3u);
+  sb::require(torn_down[0] == 'b' && torn_down[1] == 'c' && torn_down[2] == 'a');
+  sb::require(first.built() == false && second.built() == false && slow.built() == false);
+  sb::teardown_fixtures();
+  sb::require(torn, 3u);
+  sb::require(first->which, 0u);
+  sb::require(builds[0], 2u);
+  sb::require(builds[1], 1u);
+
+  sb::end_test_case();
+  return 0;
+}
@@ -0,0 +1,287 @@
+//  Copyright (c) 2024- David Lucius Severus
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  See accompanying file LICENSE.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt
+#include "expect.hpp"
+
+#include <dirent.h>
+#include <stdexcept>
+#include <stdlib.h>
+
+// files in dir whose names start with prefix
+u32
+files_in(const char *dir, const char *prefix)
+{
+  u32 n = 0;
+  if ( DIR *d = opendir(dir) ) {
+    while ( dirent *e = readdir(d) ) n += std::string(e->d_name).rfind(prefix, 0) == 0;
+    closedir(d);
+  }
+  return n;
+}
+
+void
+clear_dir(const char *dir)
+{
+  if ( DIR *d = opendir(dir) ) {
+    while ( dirent *e = readdir(d) )
+      if ( e->d_name[0] != '.' ) unlink((std::string(dir) + "/" + e->d_name).c_str());
+    closedir(d);
+  }
+}
+
+u32 calls = 0;
+
+void
+harmless(u32)
+{
+  ++calls;
+}
+
+void
+crashes_on_multiples_of_5(u32 x)
+{
+  if ( x % 5 == 0 ) {
+    volatile int *p = nullptr;
+    *p = 1;
+  }
+}
+
+// stand in for what -fsanitize-coverage=trace-cmp would insert at the comparisons
+constexpr u32 magic = 0xc0ffee;
+bool found_magic = false;
+
+void
+compares_to_magic(u32 x)
+{
+  sb::__impl::__sanitizer_cov_trace_const_cmp4(magic, x);
+  if ( x == magic ) found_magic = true;
+}
+
+void
+never_compares(u32 x)
+{
+  if ( x == magic ) found_magic = true;
+}
+
+bool found_header = false;
+
+void
+checks_header(const u8 *data, size_t len)
+{
+  static const char header[] = "SNOW";
+  if ( len < 4 ) return;
+  const int r = __builtin_memcmp(data, header, 4);
+  sb::__impl::__sanitizer_weak_hook_memcmp(nullptr, data, header, 4, r);
+  if ( r == 0 ) found_header = true;
+}
+
+u64 bytes_seen = 0;
+
+int
+counts_bytes(const u8 *, size_t len)
+{
+  bytes_seen += len;
+  return 0;
+}
+
+void
+crashes_on_bang(const u8 *data, size_t len)
+{
+  if ( len && data[0] == '!' ) {
+    volatile int *p = nullptr;
+    *p = 1;
+  }
+}
+
+// sb::init() with argv { "fuzz", args... }
+template <typename... Args>
+void
+init_with(Args... args)
+{
+  char *argv[] = { const_cast<char *>("fuzz"), const_cast<char *>(args)..., nullptr };
+  sb::init(static_cast<int>(sizeof...(Args)) + 1, argv);
+}
+
+u64 target_calls[3] = {};
+
+[[gnu::noinline]] void
+rejects_odd(u32 x)
+{
+  if ( x & 1 ) throw std::invalid_argument("odd");
+}
+
+[[gnu::noinline]] void
+rejects_large(u32 x)
+{
+  if ( x > (1u << 24) ) throw std::invalid_argument("large");
+}
+
+// two throw sites of one exception type, and a result the oracle rejects for multiples of 4
+u32
+validates(u32 x)
+{
+  rejects_large(x);
+  rejects_odd(x);
+  return x;
+}
+
+// a stack with room for every step of a sequence serves as the model for one that silently drops
+// pushes once it holds 4 items
+template <u32 Capacity> struct stack {
+  u32 items[Capacity] = {};
+  u32 n = 0;
+
+  void
+  push(u32 v)
+  {
+    if ( n < Capacity ) items[n++] = v;
+  }
+  u32
+  pop(void)
+  {
+    return n ? items[--n] : 0;
+  }
+  u32
+  size(void) const
+  {
+    return n;
+  }
+};
+
+using stack_model = stack<sb::config::__default_stateful_steps>;
+using correct_stack = stack<2 * sb::config::__default_stateful_steps>;
+using dropping_stack = stack<4>;
+
+int
+main(void)
+{
+  char dir[] = "/tmp/snowball_fuzz_XXXXXX";
+  sb::require(mkdtemp(dir) != nullptr);
+  sb::crash_dir(dir);
+
+  sb::test_case("Fuzzing a function that doesn't crash");
+  sb::fuzz(harmless, 1000);
+  sb::require(calls, 1000u);
+  sb::test_case("fuzz_stats counts every execution");
+  const u64 execs = sb::stats().execs;
+  sb::fuzz(harmless, 1000);
+  sb::require(sb::stats().execs - execs, 1000u);
+  sb::require(sb::stats().crashes, 0u);
+  sb::test_case("Fuzzing keeps going after crashes");
+  outcome o = isolated([]() { sb::fuzz(crashes_on_multiples_of_5, 200); });
+  sb::require(o.code, required_code);
+  sb::require(o.says("fuzz() crash:\033[0m SIGSEGV"));
+  sb::require(o.says("of 200 inputs crashed, 1 distinct."));
+  sb::require(files_in(dir, "crash-"), 1u);
+  clear_dir(dir);
+
+  sb::test_case("fuzz_bytes() runs inputs up to the maximum length");
+  const u64 before = sb::stats().execs;
+  sb::fuzz_bytes(counts_bytes, 5000, 64);
+  sb::require(sb::stats().execs - before, 5000u);
+  sb::require(bytes_seen > 0);
+  sb::test_case("fuzz_bytes() reports crashes");
+  o = isolated([]() { sb::fuzz_bytes(crashes_on_bang, 20000, 16); });
+  sb::require(o.code, required_code);
+  sb::require(o.says("of 20000 inputs crashed, 1 distinct."));
+  sb::require(files_in(dir, "crash-"), 1u);
+  sb::test_case("fuzz_bytes() replays corpus files given with --corpus=");
+  const std::string bang = std::string(dir) + "/bang";
+  if ( FILE *f = fopen(bang.c_str(), "w") ) {
+    fputs("!", f);
+    fclose(f);
+  }
+  o = isolated([&bang]() {
+    const std::string flag = "--corpus=" + bang;     // init() keeps pointers into argv
+    init_with(flag.c_str());
+    sb::fuzz_bytes(crashes_on_bang);
+  });
+  sb::require(o.code, required_code);
+  sb::require(o.says("1 of 1 inputs crashed"));
+  o = isolated([&bang]() {
+    init_with("--seed=7", "--", bang.c_str(), bang.c_str());
+    sb::fuzz_bytes(crashes_on_bang);
+  });
+  sb::require(o.says("2 of 2 inputs crashed"));
+  sb::test_case("Other arguments aren't taken for corpus paths");
+  o = isolated([&bang]() {
+    init_with(bang.c_str(), "--seed=7");
+    sb::fuzz_bytes(counts_bytes, 100);
+  });
+  sb::require(o.code, passed_code);
+  sb::require(o.says("corpus file") == false);
+  clear_dir(dir);
+
+  sb::test_case("fuzz_run() gives every target time");
+  sb::fuzz_target("first", [](u32) { ++target_calls[0]; });
+  sb::fuzz_target("second", [](u16) { ++target_calls[1]; });
+  sb::fuzz_target("bytes", [](const u8 *, size_t) { ++target_calls[2]; });
+  sb::fuzz_run(1);
+  for ( u64 n : target_calls ) sb::require(n > 0);
+  sb::test_case("fuzz_run() reports a crashing target");
+  o = isolated([]() {
+    sb::fuzz_target("fine", harmless);
+    sb::fuzz_target("crashy", crashes_on_multiples_of_5);
+    sb::fuzz_run(1);
+  });
+  sb::require(o.code, required_code);
+  sb::require(o.in_order("fuzz_run():", "fine: "));
+  sb::require(o.in_order("fine: ", "crashy: "));
+  sb::require(o.says("1 distinct."));
+  clear_dir(dir);
+  sb::test_case("fuzz_run() seeds the rng when only byte targets are registered");
+  o = isolated([]() {
+    sb::__impl::__fuzz_state = 0;     // as in a process that hasn't fuzzed anything yet
+    static size_t longest = 0;
+    sb::fuzz_target("bytes only", [](const u8 *, size_t len) { longest = len > longest ? len : longest; });
+    sb::fuzz_run(1);
+    sb::require(longest > 0);
+  });
+  sb::require(o.code, passed_code);
+
+  sb::test_case("fuzz_checked() passes when nothing throws and the oracle agrees");
+  sb::fuzz_checked([](u32 x) { return x / 2; }, 2000, [](u32 x, u32 half) { return half * 2 == x - x % 2; });
+  sb::test_case("fuzz_checked() buckets failures by throw site");
+  o = isolated([]() { sb::fuzz_checked(validates, 5000); });
+  sb::require(o.code, required_code);
+  sb::require(o.says("2 distinct failure(s) in 5000 inputs"));
+  sb::require(o.says("threw std::invalid_argument: large"));
+  sb::require(o.says("threw std::invalid_argument: odd"));
+  sb::require(files_in(dir, "failure-"), 2u);
+  o = isolated([]() { sb::fuzz_checked(validates, 5000, [](u32 r) { return r % 4 != 0; }); });
+  sb::require(o.says("3 distinct failure(s) in 5000 inputs"));
+  sb::require(o.says("oracle rejected the result"));
+  clear_dir(dir);
+
+  sb::test_case("Compared constants are tried as inputs");
+  sb::fuzz(never_compares, 2000);
+  sb::require(found_magic == false);
+  const u64 dictionary = sb::stats().dictionary;
+  sb::fuzz(compares_to_magic, 2000);
+  sb::require(found_magic);
+  sb::require(sb::stats().dictionary > dictionary);
+  sb::test_case("Compared buffers are spliced into fuzz_bytes() inputs");
+  sb::fuzz_bytes(checks_header, 20000, 16);
+  sb::require(found_header);
+
+  sb::test_case("fuzz_stateful() passes an object that matches its model");
+  sb::fuzz_stateful(correct_stack{}, stack_model{}, sb::op("push", &correct_stack::push, &stack_model::push),
+                    sb::op("pop", &correct_stack::pop, &stack_model::pop),
+                    sb::op("size", &correct_stack::size, &stack_model::size));
+  sb::test_case("fuzz_stateful() shrinks a sequence that diverges");
+  o = isolated([]() {
+    sb::fuzz_stateful(dropping_stack{}, stack_model{}, sb::op("push", &dropping_stack::push, &stack_model::push),
+                      sb::op("pop", &dropping_stack::pop, &stack_model::pop),
+                      sb::op("size", &dropping_stack::size, &stack_model::size));
+  });
+  sb::require(o.code, required_code);
+  sb::require(o.says("fuzz_stateful() failure:"));
+  sb::require(o.in_order("shrunk to", "push"));
+  sb::require(o.says("model returned"));
+
+  sb::end_test_case();
+  rmdir(dir);
+  return 0;
+}
@@ -0,0 +1,89 @@
+//  Copyright (c) 2024- David Lucius Severus
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  See accompanying file LICENSE.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt
+#include "expect.hpp"
+
+// a register: writes store value, reads return it in out
+struct reg_op {
+  u32 write;
+  u32 value;
+  u32 out;
+};
+
+struct reg_model {
+  u32 value = 0;
+
+  bool
+  step(const reg_op &op)
+  {
+    if ( op.write ) {
+      value = op.value;
+      return true;
+    }
+    return op.out == value;
+  }
+
+  // deliberately useless, every state collides
+  u64
+  hash(void) const
+  {
+    return 0;
+  }
+
+  bool
+  operator==(const reg_model &o) const
+  {
+    return value == o.value;
+  }
+};
+
+// the ops are recorded from one thread, with invoke/respond interleaved to make them overlap
+struct recorder {
+  sb::history<reg_op> h{ 3, 16 };
+
+  size_t
+  call(u32 thread, reg_op op)
+  {
+    return h.invoke(thread, op);
+  }
+
+  void
+  done(u32 thread, size_t id, reg_op op)
+  {
+    h.respond(thread, id, op);
+  }
+};
+
+int
+main(void)
+{
+  sb::test_case("Concurrent writes linearize in either order");
+  // w(1) and w(2) overlap, a later read sees 1: only the order w(2), w(1) explains it, and the search
+  // reaches the same set {w(1), w(2)} with state 2 first
+  recorder a;
+  size_t w1 = a.call(0, { 1, 1, 0 });
+  size_t w2 = a.call(1, { 1, 2, 0 });
+  a.done(0, w1, { 1, 1, 0 });
+  a.done(1, w2, { 1, 2, 0 });
+  size_t r = a.call(2, { 0, 0, 0 });
+  a.done(2, r, { 0, 0, 1 });
+  sb::require_linearizable(a.h, reg_model{});
+
+  sb::test_case("A read of a value never written is not linearizable");
+  recorder b;
+  w1 = b.call(0, { 1, 1, 0 });
+  b.done(0, w1, { 1, 1, 0 });
+  w2 = b.call(1, { 1, 2, 0 });
+  b.done(1, w2, { 1, 2, 0 });
+  r = b.call(2, { 0, 0, 0 });
+  b.done(2, r, { 0, 0, 1 });
+  outcome o = isolated([&]() { sb::require_linearizable(b.h, reg_model{}); });
+  sb::require(o.code, required_code);
+  sb::require(o.says("require_linearizable() failure"));
+  o = isolated([&]() { sb::check_linearizable(b.h, reg_model{}); });
+  sb::require(o.code, checks_failed_code);
+  sb::end_test_case();
+  return 0;
+}
@@ -0,0 +1,115 @@
+//  Copyright (c) 2024- David Lucius Severus
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  See accompanying file LICENSE.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt
+#include "expect.hpp"
+
+#include <string>
+
+// trivially copyable, and without an operator==
+struct point {
+  i32 x;
+  i32 y;
+};
+
+int
+main(void)
+{
+  static u32 a[100000], b[100000];
+  for ( u32 i = 0; i < 100000; ++i ) a[i] = b[i] = i * 2654435761u;
+
+  sb::test_case("Equal ranges");
+  sb::require_equal_range(a, b);
+  sb::require_equal_range(a, b, 100000);
+  sb::test_case("Ranges differing at one element");
+  b[76543] ^= 0x100;
+  outcome o = isolated([&]() { sb::require_equal_range(a, b); });
+  sb::require(o.code, required_code);
+  sb::require(o.says("ranges differ at index 76543 (byte 306173)"));
+  o = isolated([&]() { sb::check_equal_range(a, b, 100000); });
+  sb::require(o.code, checks_failed_code);
+  sb::require(o.says("check_equal_range() failure"));
+  sb::test_case("Ranges differing in length");
+  o = isolated([&]() { sb::check_equal_range(a, b, 76543); });
+  sb::require(o.code, passed_code);
+  u32 shorter[3] = { 1, 2, 3 };
+  u32 longer[4] = { 1, 2, 3, 4 };
+  o = isolated([&]() { sb::require_equal_range(shorter, longer); });
+  sb::require(o.code, required_code);
+  sb::require(o.says("ranges differ in length (3 vs 4)"));
+
+  sb::test_case("Floats within a few ulps");
+  const float one = 1.0f;
+  const float next = __builtin_bit_cast(float, __builtin_bit_cast(u32, one) + 3);
+  sb::require_near(one, next, 3);
+  o = isolated([&]() { sb::require_near(one, next, 2); });
+  sb::require(o.code, required_code);
+  sb::require(o.says("1 of 1 elements not within 2 ulps"));
+  sb::test_case("Float arrays with a few elements off");
+  static float x[300000], y[300000];
+  for ( u32 i = 0; i < 300000; ++i ) x[i] = y[i] = static_cast<float>(i) * 0.25f;
+  y[7] = __builtin_bit_cast(float, __builtin_bit_cast(u32, y[7]) + 1);
+  sb::require_all_near(x, y, 1, 0.0);
+  y[123456] *= 1.001f;
+  y[299999] = __builtin_nanf("");
+  o = isolated([&]() { sb::check_all_near(x, y, 1, 0.0); });
+  sb::require(o.code, checks_failed_code);
+  sb::require(o.says("2 of 300000 elements not within 1 ulps"));
+  sb::require(o.says("worst at index 299999"));
+  sb::require(o.says("[nan] 1"));
+  o = isolated([&]() { sb::require_all_near(x, y, 1, 0.01); });
+  sb::require(o.code, required_code);
+  sb::require(o.says("1 of 300000 elements"));
+
+  sb::test_case("Same elements in any order");
+  u32 p[6] = { 5, 1, 4, 1, 9, 2 };
+  u32 q[6] = { 1, 9, 2, 5, 1, 4 };
+  sb::require_same_elements(p, q);
+  q[4] = 3;
+  o = isolated([&]() { sb::check_same_elements(p, q); });
+  sb::require(o.code, checks_failed_code);
+  sb::require(o.says("1 element(s) only in a, 1 element(s) only in b"));
+  sb::require(o.says("only in a (x1): 1"));
+  sb::require(o.says("only in b (x1): 3"));
+  sb::test_case("Same elements without operator==");
+  const point pa[3] = { { 1, 2 }, { 3, 4 }, { 1, 2 } };
+  point pb[3] = { { 3, 4 }, { 1, 2 }, { 1, 2 } };
+  sb::require_same_elements(pa, pb);
+  pb[2].y = 5;
+  o = isolated([&]() { sb::require_same_elements(pa, pb); });
+  sb::require(o.code, required_code);
+  sb::require(o.says("1 element(s) only in a, 1 element(s) only in b"));
+  sb::test_case("Same strings in any order");
+  const std::string sa[3] = { "alpha", "beta", "gamma" };
+  const std::string sb_[3] = { "gamma", "alpha", "beta" };
+  sb::require_same_elements(sa, sb_);
+
+  sb::test_case("Predicates over every element");
+  static u32 v[100000];
+  for ( u32 i = 0; i < 100000; ++i ) v[i] = 2 * i;
+  sb::require_all(v, [](u32 e) { return e % 2 == 0; });
+  sb::require_none(v, [](u32 e) { return e % 2 == 1; });
+  sb::check_all(v, 10, [](u32 e) { return e < 20; });
+  sb::test_case("Predicates failing across blocks");
+  for ( u32 i = 4999; i < 100000; i += 5000 ) v[i] = 1;
+  o = isolated([&]() { sb::require_all(v, [](u32 e) { return e % 2 == 0; }); });
+  sb::require(o.code, required_code);
+  sb::require(o.says("require_all() failure:\033[0m 20 of 100000 elements failed the predicate, the first ones:"));
+  for ( u32 i = 4999; i < 75000; i += 5000 ) {
+    const std::string at = "[" + std::to_string(i) + "]: 1", later = "[" + std::to_string(i + 5000) + "]: 1";
+    sb::require(o.in_order(at.c_str(), later.c_str()));
+  }
+  sb::require(o.says("[84999]") == false);
+  o = isolated([&]() { sb::check_none(v, [](u32 e) { return e == 1; }); });
+  sb::require(o.code, checks_failed_code);
+  sb::require(o.says("check_none() failure:\033[0m 20 of 100000 elements matched the predicate"));
+  o = isolated([&]() { sb::check_all(v, 10000, [](u32 e) { return e % 2 == 0; }); });
+  sb::require(o.code, checks_failed_code);
+  sb::require(o.says("2 of 10000 elements failed the predicate:"));
+  sb::require(o.in_order("[4999]: 1", "[9999]: 1"));
+  o = isolated([&]() { sb::require_none(v, 4999, [](u32 e) { return e == 1; }); });
+  sb::require(o.code, passed_code);
+  sb::end_test_case();
+  return 0;
+}
@@ -3,7 +3,7 @@
 //  Distributed under the Boost Software License, Version 1.0.
 //  See accompanying file LICENSE.txt or copy at
 //  http://www.boost.org/LICENSE_1_0.txt
-#include "../include/snowball.hpp"
+#include "expect.hpp"
 
 #include <exception>
 #include <stdexcept>
@@ -74,6 +74,29 @@ main(void)
   sb::require(&all_zero, 0, (long)0, (char)0);
   sb::test_case("Function calling inline execution");
   sb::require(&returns_5, 5);
+  sb::test_case("Table of function calls");
+  const sb::row<bool, int, long, char> rows[] = { { true, 0, 0, 0 }, { false, 1, 0, 0 }, { false, 0, 0, 'a' } };
+  sb::require_table(&all_zero, rows);
+  sb::test_case("Mismatching table rows are reported together");
+  outcome o = isolated([]() {
+    const sb::row<int, int> squares[] = { { 0, 0 }, { 1, 1 }, { 5, 2 }, { 9, 3 }, { 17, 4 }, { 25, 5 }, { 35, 6 } };
+    sb::check_table([](int x) { return x * x; }, squares);
+  });
+  sb::require(o.code == checks_failed_code);
+  sb::require(o.says("check_table() failure:\033[0m 3 of 7 rows mismatched, rows: 2 4 6\n"));
+  sb::require(o.in_order("  row 2: got 4, expected 5\n", "  row 4: got 16, expected 17\n"));
+  sb::require(o.in_order("  row 4: got 16, expected 17\n", "  row 6: got 36, expected 35\n"));
+  sb::test_case("Table reports stop at the report limit");
+  o = isolated([]() {
+    constexpr size_t n = sb::config::__default_table_report + 4;
+    sb::row<size_t, size_t> counted[n];
+    for ( size_t i = 0; i < n; ++i ) counted[i] = { i + 1, i };
+    sb::check_table([](size_t x) { return x; }, counted);
+  });
+  sb::require(o.code == checks_failed_code);
+  sb::require(o.says("20 of 20 rows mismatched, rows: 0 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 ...\n"));
+  sb::require(o.says("  row 15: got 15, expected 16\n"));
+  sb::require(!o.says("  row 16:"));
   sb::test_case("Object testing");
   obj object;
   sb::require(object, &obj::set, 1, 1, &obj::get);
@@ -0,0 +1,139 @@
+//  Copyright (c) 2024- David Lucius Severus
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  See accompanying file LICENSE.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt
+#include "expect.hpp"
+
+#include <string>
+
+#include <stdlib.h>
+
+struct timed {
+  const char *name;
+  u64 us;
+};
+
+// in the timings file
+const timed known[] = { { "t800", 800 }, { "t700", 700 }, { "t600", 600 }, { "t500", 500 },
+                        { "t400", 400 }, { "t300", 300 }, { "t200", 200 }, { "t100", 100 } };
+// missing from it
+const char *const unknown[] = { "new1", "new2", "new3" };
+constexpr u32 shards = 3;
+
+std::string
+read_text(const std::string &path)
+{
+  size_t len = 0;
+  u8 *buf = sb::__impl::__read_file(path.c_str(), len);
+  std::string s(reinterpret_cast<const char *>(buf), len);
+  delete[] buf;
+  return s;
+}
+
+void
+write_text(const std::string &path, const std::string &text)
+{
+  sb::__impl::__write_file(path.c_str(), reinterpret_cast<const u8 *>(text.data()), text.size());
+}
+
+// runs every case in shard i of n in a child, which prints "ran <name>" for each case it ran and
+// then exits normally so its timings are written
+outcome
+run_shard(const std::string &timings, u32 i, u32 n)
+{
+  return isolated([&]() {
+    sb::timings_file(timings.c_str());
+    sb::shard(i, n);
+    auto run = [](const char *name) {
+      if ( sb::test_case(name, []() {}) ) sb::print("ran ", name);
+    };
+    for ( const timed &t : known ) run(t.name);
+    for ( const char *name : unknown ) run(name);
+    ::exit(passed_code);
+  });
+}
+
+bool
+ran(const outcome &o, const char *name)
+{
+  return o.says((std::string("ran ") + name + "\n").c_str());
+}
+
+int
+main(void)
+{
+  char dir[] = "/tmp/snowball_shard_XXXXXX";
+  sb::require(mkdtemp(dir) != nullptr);
+  const std::string timings = std::string(dir) + "/timings";
+  std::string file;
+  for ( const timed &t : known ) file += std::to_string(t.us) + " " + t.name + "\n";
+  write_text(timings, file);
+
+  outcome runs[shards];
+  for ( u32 i = 0; i < shards; ++i ) {
+    runs[i] = run_shard(timings, i, shards);
+    sb::require(runs[i].code, passed_code);
+  }
+
+  sb::test_case("Every case runs in exactly one shard");
+  for ( const timed &t : known ) {
+    u32 owners = 0;
+    for ( const outcome &o : runs ) owners += ran(o, t.name);
+    sb::require(owners, 1u);
+  }
+  for ( const char *name : unknown ) {
+    u32 owners = 0;
+    for ( const outcome &o : runs ) owners += ran(o, name);
+    sb::require(owners, 1u);
+  }
+
+  sb::test_case("Known durations are balanced");
+  // longest first, each onto the least loaded shard: 800+300+200, 700+400+100, 600+500
+  const u64 planned[shards] = { 1300, 1200, 1100 };
+  for ( u32 i = 0; i < shards; ++i ) {
+    u64 load = 0;
+    for ( const timed &t : known )
+      if ( ran(runs[i], t.name) ) load += t.us;
+    sb::require(load, planned[i]);
+  }
+
+  sb::test_case("Cases missing from the timings go to the least loaded shard");
+  // each one adds the mean known duration to the shard it goes to, the lightest one first
+  for ( const outcome &o : runs ) {
+    u32 mine = 0;
+    for ( const char *name : unknown ) mine += ran(o, name);
+    sb::require(mine, 1u);
+  }
+  sb::require(ran(runs[2], "new1") && ran(runs[1], "new2") && ran(runs[0], "new3"));
+
+  sb::test_case("Sharded runs write their own timings file");
+  sb::require(read_text(timings), file);
+  for ( u32 i = 0; i < shards; ++i ) {
+    const std::string own = read_text(timings + "." + std::to_string(i));
+    auto lists = [&own](const char *name) { return own.find(std::string(" ") + name + "\n") != std::string::npos; };
+    for ( const timed &t : known ) sb::require(lists(t.name), ran(runs[i], t.name));
+    for ( const char *name : unknown ) sb::require(lists(name), ran(runs[i], name));
+    ::unlink((timings + "." + std::to_string(i)).c_str());
+  }
+
+  sb::test_case("A failing case still has its duration recorded");
+  const std::string failing = std::string(dir) + "/failing";
+  outcome o = isolated([&]() {
+    sb::timings_file(failing.c_str());
+    sb::test_case("passes", []() {});
+    sb::test_case("fails", []() { sb::require(false); });
+    sb::test_case("never reached", []() {});
+  });
+  sb::require(o.code, required_code);
+  const std::string recorded = read_text(failing);
+  sb::require(recorded.find(" passes\n") != std::string::npos);
+  sb::require(recorded.find(" fails\n") != std::string::npos);
+  sb::require(recorded.find("never reached") == std::string::npos);
+  ::unlink(failing.c_str());
+  ::unlink(timings.c_str());
+  ::rmdir(dir);
+
+  sb::end_test_case();
+  return 0;
+}
@@ -0,0 +1,140 @@
+//  Copyright (c) 2024- David Lucius Severus
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  See accompanying file LICENSE.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt
+#include "expect.hpp"
+
+inline const sb::grammar arith(R"bnf(
+  expr   ::= term (("+" | "-") term)*
+  term   ::= number | "(" expr ")"
+  number ::= "0" | "-"? [1-9] [0-9]*
+)bnf");
+
+// recognizes arith sentences, p is advanced past what was matched
+bool expr(const char *&p);
+
+bool
+number(const char *&p)
+{
+  if ( *p == '0' ) return ++p, true;
+  if ( *p == '-' ) ++p;
+  if ( *p < '1' || *p > '9' ) return false;
+  while ( *p >= '0' && *p <= '9' ) ++p;
+  return true;
+}
+
+bool
+term(const char *&p)
+{
+  if ( *p != '(' ) return number(p);
+  ++p;
+  if ( !expr(p) || *p != ')' ) return false;
+  ++p;
+  return true;
+}
+
+bool
+expr(const char *&p)
+{
+  if ( !term(p) ) return false;
+  while ( *p == '+' || *p == '-' ) {
+    ++p;
+    if ( !term(p) ) return false;
+  }
+  return true;
+}
+
+bool
+parses(const char *s, size_t n)
+{
+  const char *p = s;
+  return expr(p) && p == s + n;
+}
+
+// strict: no overlong forms, surrogates or code points past U+10FFFF
+bool
+valid_utf8(const char *s, size_t n)
+{
+  const u8 *p = reinterpret_cast<const u8 *>(s);
+  for ( size_t i = 0; i < n; ) {
+    const u8 c = p[i];
+    u32 len, cp;
+    if ( c < 0x80 ) {
+      ++i;
+      continue;
+    } else if ( c >= 0xc2 && c <= 0xdf ) {
+      len = 2;
+      cp = c & 0x1f;
+    } else if ( c >= 0xe0 && c <= 0xef ) {
+      len = 3;
+      cp = c & 0x0f;
+    } else if ( c >= 0xf0 && c <= 0xf4 ) {
+      len = 4;
+      cp = c & 0x07;
+    } else {
+      return false;
+    }
+    if ( i + len > n ) return false;
+    for ( u32 k = 1; k < len; ++k ) {
+      if ( (p[i + k] & 0xc0) != 0x80 ) return false;
+      cp = (cp << 6) | (p[i + k] & 0x3f);
+    }
+    if ( (len == 3 && cp < 0x800) || (len == 4 && cp < 0x10000) || cp > 0x10ffff ) return false;
+    if ( cp >= 0xd800 && cp <= 0xdfff ) return false;
+    i += len;
+  }
+  return true;
+}
+
+int
+main(void)
+{
+  sb::test_case("Every sentence parses under its grammar");
+  sb::fuzz([](sb::sentence<arith> s) { sb::require(parses(s.data(), s.size())); }, 5000);
+  sb::test_case("utf8<N> is valid utf-8 of at most N bytes");
+  sb::fuzz(
+      [](sb::utf8<64> s) {
+        sb::require(s.size() <= 64u);
+        sb::require(valid_utf8(s.data(), s.size()));
+        sb::require(s.c_str()[s.size()] == 0);
+      },
+      20000);
+  sb::test_case("printable<N> is printable ascii of at most N bytes");
+  sb::fuzz(
+      [](sb::printable<8> s) {
+        sb::require(s.size() <= 8u);
+        for ( size_t i = 0; i < s.size(); ++i ) sb::require(s[i] >= ' ' && s[i] <= '~');
+      },
+      5000);
+
+  sb::test_case("Malformed grammars fail when they are constructed");
+  outcome o = isolated([]() { sb::grammar g("start ::= item+"); });
+  sb::require(o.code, required_code);
+  sb::require(o.says("line 1: undefined rule item"));
+  o = isolated([]() { sb::grammar g("start ::= 'a' | list\n  list ::= 'b' list"); });
+  sb::require(o.code, required_code);
+  sb::require(o.says("line 2: rule never terminates: list"));
+  o = isolated([]() { sb::grammar g("start ::= ('a' | 'b'))"); });
+  sb::require(o.code, required_code);
+  sb::require(o.says("unbalanced ')'"));
+  o = isolated([]() { sb::grammar g("start ::= ('a' | 'b'"); });
+  sb::require(o.code, required_code);
+  sb::require(o.says("expected ')'"));
+
+  sb::test_case("Text past the last arena block fails");
+  o = isolated([]() {
+    sb::__impl::__text_arena arena;
+    const u8 line[3000] = {};
+    for ( u32 i = 0; i < 3 * sb::__impl::__text_arena::max_blocks; ++i ) {
+      size_t len;
+      arena.put(line, sizeof(line));
+      arena.finish(len);
+    }
+  });
+  sb::require(o.code, required_code);
+  sb::require(o.says("spans more than 40 arena blocks"));
+
+  sb::end_test_case();
+  return 0;
+}
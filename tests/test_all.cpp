@@ -0,0 +1,149 @@
+//  Copyright (c) 2024- David Lucius Severus
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  See accompanying file LICENSE.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt
+#include "expect.hpp"
+
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+// runs scripts/test_all.cpp, built next to this binary, against small shell scripts standing in for
+// test binaries
+
+std::string dir;
+std::vector<std::string> created;
+
+std::string
+driver(void)
+{
+  char self[4096];
+  const ssize_t n = readlink("/proc/self/exe", self, sizeof(self) - 1);
+  if ( n <= 0 ) return "snowball_test_all";
+  std::string path(self, static_cast<size_t>(n));
+  return path.substr(0, path.rfind('/') + 1) + "snowball_test_all";
+}
+
+void
+script(const std::string &path, const std::string &body, mode_t mode = 0755,
+       const char *interpreter = "/bin/sh")
+{
+  const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, mode);
+  const std::string text = "#!" + std::string(interpreter) + "\n" + body + "\n";
+  sb::require(fd >= 0 && ::write(fd, text.data(), text.size()) == static_cast<ssize_t>(text.size()));
+  ::close(fd);
+  created.push_back(path);
+}
+
+std::string
+subdir(const char *name)
+{
+  const std::string path = dir + "/" + name;
+  sb::require(::mkdir(path.c_str(), 0755) == 0);
+  created.push_back(path);
+  return path;
+}
+
+// runs the driver with args, its exit code and output captured like an isolated() test case
+outcome
+run_driver(const std::vector<std::string> &args)
+{
+  return isolated([&]() {
+    std::string exe = driver();
+    std::vector<char *> argv{ exe.data() };
+    for ( const std::string &a : args ) argv.push_back(const_cast<char *>(a.c_str()));
+    argv.push_back(nullptr);
+    ::execv(exe.c_str(), argv.data());
+    _exit(126);
+  });
+}
+
+// the most scripts logging to log that were running at once
+int
+most_at_once(const std::string &log)
+{
+  size_t len = 0;
+  u8 *buf = sb::__impl::__read_file(log.c_str(), len);
+  int now = 0, most = 0;
+  for ( size_t i = 0; i < len; ++i ) {
+    if ( buf[i] == 's' ) most = ++now > most ? now : most;
+    if ( buf[i] == 'e' ) --now;
+  }
+  delete[] buf;
+  return most;
+}
+
+int
+main(void)
+{
+  char tmpl[] = "/tmp/snowball_test_all.XXXXXX";
+  sb::require(::mkdtemp(tmpl) != nullptr);
+  dir = tmpl;
+
+  sb::test_case("Exit codes, signals and timeouts are told apart");
+  const std::string mixed = subdir("mixed");
+  script(mixed + "/passes", "echo all good");
+  script(mixed + "/requires", "echo required output; exit 6");
+  script(mixed + "/returns", "exit 3");
+  script(mixed + "/crashes", "kill -SEGV $$");
+  script(mixed + "/hangs", "sleep 30");
+  script(mixed + "/unrunnable", "exit 0", 0644);     // not executable, skipped
+  // an interpreter that isn't there makes execv fail in the driver's child
+  script(mixed + "/missing", "exit 0", 0755, "/nonexistent/interpreter");
+  outcome o = run_driver({ "--timeout=1", mixed });
+  sb::require(o.code == 1);
+  sb::require(o.says("passes: PASS\n"));
+  sb::require(o.says("requires: FAIL (snowball require failure)\n"));
+  sb::require(o.says("returns: FAIL (returned 3)\n"));
+  sb::require(o.says("crashes: CRASH (SIGSEGV)\n"));
+  sb::require(o.says("hangs: TIMEOUT (killed after 1s)\n"));
+  sb::require(o.says("missing: ERROR (couldn't execute)\n"));
+  sb::require(!o.says("unrunnable"));
+  sb::require(o.says("1/6 passed in "));
+  // failures come first, with their output, and passing output stays hidden
+  sb::require(o.in_order("/requires ====\033[0m\nrequired output\n", "passes: PASS"));
+  sb::require(!o.says("all good"));
+
+  sb::test_case("-j takes the next argument only when it's a count");
+  const std::string passing = subdir("passing");
+  script(passing + "/one", "exit 0");
+  script(passing + "/two", "exit 0");
+  o = run_driver({ "-j", "3", passing });
+  sb::require(o.code == 0);
+  sb::require(o.says("2/2 passed in ") && o.says("(-j3)"));
+  o = run_driver({ "-j", passing });
+  sb::require(o.code == 0);
+  sb::require(o.says("2/2 passed in "));
+  o = run_driver({ "-j2", passing, "--", "ignored" });
+  sb::require(o.code == 0 && o.says("(-j2)"));
+
+  sb::test_case("A make jobserver bounds the parallelism and gets its tokens back");
+  const std::string slow = subdir("slow");
+  const std::string log = dir + "/log";
+  created.push_back(log);
+  for ( const char *name : { "a", "b", "c", "d", "e", "f" } )
+    script(slow + "/" + name, "printf s >> " + log + "; sleep 0.2; printf e >> " + log);
+  int tokens[2];
+  sb::require(::pipe(tokens) == 0);
+  sb::require(::write(tokens[1], "++", 2) == 2);     // two tokens, plus the driver's implicit one
+  const std::string flags = "-j3 --jobserver-auth=" + std::to_string(tokens[0]) + "," + std::to_string(tokens[1]);
+  ::setenv("MAKEFLAGS", flags.c_str(), 1);
+  o = run_driver({ slow });
+  ::unsetenv("MAKEFLAGS");
+  sb::require(o.code == 0 && o.says("6/6 passed in "));
+  sb::require(most_at_once(log) == 3);
+  ::fcntl(tokens[0], F_SETFL, O_NONBLOCK);
+  char back[4];
+  sb::require(::read(tokens[0], back, sizeof(back)) == 2);
+  ::close(tokens[0]);
+  ::close(tokens[1]);
+  sb::end_test_case();
+
+  for ( auto it = created.rbegin(); it != created.rend(); ++it ) ::remove(it->c_str());
+  ::rmdir(dir.c_str());
+  return 0;
+}
@@ -0,0 +1,67 @@
+//  Copyright (c) 2024- David Lucius Severus
+//
+//  Distributed under the Boost Software License, Version 1.0.
+//  See accompanying file LICENSE.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt
+#include "expect.hpp"
+
+size_t
+occurrences(const std::string &s, const char *what)
+{
+  size_t n = 0;
+  for ( size_t i = s.find(what); i != std::string::npos; i = s.find(what, i + 1) ) ++n;
+  return n;
+}
+
+// every report is whole: one header, one mismatch line and both hex lines, for the same index
+bool
+reports_intact(const std::string &out, size_t expected)
+{
+  const char *header = ":: Test case error";
+  size_t reports = 0;
+  for ( size_t at = out.find(header); at != std::string::npos; ++reports ) {
+    const size_t end = out.find(header, at + 1);
+    const std::string one = out.substr(at, end == std::string::npos ? std::string::npos : end - at);
+    at = end;
+    // stress() reports the failed checks once more when it's done
+    if ( one.find("stress() failure") != std::string::npos ) {
+      --reports;
+      continue;
+    }
+    const size_t idx = one.find("differ at index ");
+    if ( idx == std::string::npos || occurrences(one, "differ at index ") != 1 ) return false;
+    if ( occurrences(one, "  a @") != 1 || occurrences(one, "  b @") != 1 ) return false;
+    // thread t's ranges differ at index t, where b holds t + 1
+    const std::string marked = std::string("[0") + static_cast<char>(one[idx + 16] + 1) + "]";
+    if ( occurrences(one, "[00]") != 1 || occurrences(one, marked.c_str()) != 1 ) return false;
+  }
+  return reports == expected;
+}
+
+int
+main(void)
+{
+  sb::test_case("Stress with a correct atomic counter");
+  u64 counter = 0;
+  sb::stress(4, 20000, [&]() { __atomic_fetch_add(&counter, 1, __ATOMIC_RELAXED); });
+  sb::require(counter, static_cast<u64>(4 * 20000));
+  sb::test_case("Stress with jitter and per-thread arguments");
+  u64 per_thread[3] = {};
+  sb::stress(
+      3, 1000, [&](u32 t, u64 i) { return __atomic_add_fetch(&per_thread[t], 1, __ATOMIC_RELAXED) == i + 1; }, true);
+  sb::require(per_thread[0] + per_thread[1] + per_thread[2], static_cast<u64>(3000));
+  sb::test_case("Stress counts failing iterations per thread");
+  outcome o = isolated([]() { sb::stress(2, 100, [](u32 t, u64 i) { return t == 0 || i % 10 != 0; }); });
+  sb::require(o.code, required_code);
+  sb::require(o.says("stress() failure:\033[0m 10 failure(s); per thread: 0 10"));
+  sb::test_case("Reports from concurrent threads don't interleave");
+  o = isolated([]() {
+    static u8 a[4][64], b[4][64];
+    for ( u32 t = 0; t < 4; ++t ) b[t][t] = static_cast<u8>(t + 1);
+    sb::stress(4, 50, [&](u32 t) { sb::check_equal_range(a[t], b[t], 64); });
+  });
+  sb::require(o.code, required_code);
+  sb::require(reports_intact(o.output, 200));
+  sb::end_test_case();
+  return 0;
+}